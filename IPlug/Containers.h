@@ -3,6 +3,8 @@
 #include <assert.h>
 #include <string.h>
 
+#include <atomic>
+
 #include "WDL/heapbuf.h"
 #include "WDL/wdlstring.h"
 #include "WDL/wdltypes.h"
@@ -11,20 +13,145 @@
 	#include "WDL/wdlendian.h"
 #endif
 
+// Stream that ByteChunk can write data to, or read data from (see
+// ByteChunk::SetStream()), so data of arbitrary size can be saved or
+// loaded without buffering all of it. Implement Read() and/or Write().
+
+class ByteChunkStream
+{
+public:
+	// Optimal default buffer size = 64 KB - 96, see WDL_HeapBuf.
+	static const int kDefaultBufSize = 65440;
+
+	ByteChunkStream(const int bufSize = kDefaultBufSize): mBufSize(bufSize), mBufPos(0), mBufEnd(0) {}
+	virtual ~ByteChunkStream() {}
+
+	// Reads up to size bytes, returns number of bytes read (0 at end of
+	// stream), or < 0 on error.
+	virtual int Read(void* /* pBuf */, int /* size */) { return -1; }
+
+	// Writes all bytes, returns false on error.
+	virtual bool Write(const void* /* pBuf */, int /* size */) { return false; }
+
+	// Returns data from startPos up to startPos + size in stream, or NULL
+	// if out of bounds. Returned data is only valid until next call.
+	const char* GetData(const int startPos, const int size)
+	{
+		if (startPos < mBufPos || size < 0) return NULL;
+
+		const int bufEnd = mBufEnd;
+		if (startPos + size <= bufEnd) return (const char*)mBuf.GetFast() + (startPos - mBufPos);
+
+		// Keep data from startPos, and fill rest of buffer.
+		const int keep = wdl_max(bufEnd - startPos, 0);
+		char* const buf = (char*)mBuf.ResizeOK(wdl_max(wdl_max(mBufSize, size), mBuf.GetSize()), false);
+		if (!buf) return NULL;
+
+		if (keep) memmove(buf, buf + (startPos - mBufPos), keep);
+		mBufPos = startPos;
+		mBufEnd = startPos + keep;
+
+		// Skip data up to startPos (if any).
+		for (int skip = startPos - bufEnd; skip > 0;)
+		{
+			const int n = Read(buf, wdl_min(skip, mBuf.GetSize()));
+			if (n <= 0) return NULL;
+			skip -= n;
+		}
+
+		while (mBufEnd < startPos + size)
+		{
+			const int n = Read(buf + (mBufEnd - mBufPos), mBuf.GetSize() - (mBufEnd - mBufPos));
+			if (n <= 0) return NULL;
+			mBufEnd += n;
+		}
+
+		return buf;
+	}
+
+	// Same as above, but copies data to pBuf, reading large data directly
+	// from stream. Returns end position, or -1 if out of bounds.
+	int GetBytes(void* const pBuf, const int size, const int startPos)
+	{
+		if (size <= mBufSize || startPos < mBufPos || startPos > mBufEnd)
+		{
+			const char* const pData = GetData(startPos, size);
+			if (!pData) return -1;
+
+			memcpy(pBuf, pData, size);
+			return startPos + size;
+		}
+
+		int n = mBufEnd - startPos;
+		memcpy(pBuf, (const char*)mBuf.GetFast() + (startPos - mBufPos), n);
+
+		while (n < size)
+		{
+			const int nRead = Read((char*)pBuf + n, size - n);
+			if (nRead <= 0) return -1;
+			n += nRead;
+		}
+
+		mBufPos = mBufEnd = startPos + size;
+		return mBufEnd;
+	}
+
+private:
+	WDL_HeapBuf mBuf;
+	int mBufSize, mBufPos, mBufEnd;
+};
+
 class ByteChunk
 {
 public:
-	ByteChunk(): mSize(0) {}
+	// If IPLUG_GROWABLE_CHUNKS is defined, then chunks are growable by
+	// default (see SetGrowable()).
+	#ifdef IPLUG_GROWABLE_CHUNKS
+	ByteChunk(): mpView(NULL), mpStream(NULL), mSize(0), mGrowable(true) {}
+	#else
+	ByteChunk(): mpView(NULL), mpStream(NULL), mSize(0), mGrowable(false) {}
+	#endif
+
 	~ByteChunk() {}
 
+	// If growable, then Put*() reallocates if data doesn't fit (growing
+	// allocated size by at least 1.5x, so n puts cost amortized O(n)),
+	// instead of returning 0. Don't use on audio thread.
+	inline void SetGrowable(const bool growable = true) { mGrowable = growable; }
+	inline bool IsGrowable() const { return mGrowable; }
+
+	// Streaming: Put*() writes data to stream whenever allocated size is
+	// full (call FlushStream() when done), and Get*() reads data from
+	// stream. Data is read sequentially, so you can't go back further than
+	// the stream's buffer. Don't call Size() or GetBytes() while
+	// streaming, because they don't cover streamed data.
+	inline void SetStream(ByteChunkStream* const pStream) { mpStream = pStream; }
+	inline ByteChunkStream* GetStream() const { return mpStream; }
+
+	// Writes data to stream, returns false on error.
+	bool FlushStream()
+	{
+		const int size = mSize;
+		if (!mpStream || !size) return true;
+
+		mSize = 0;
+		return mpStream->Write(mBytes.GetFast(), size);
+	}
+
 	int PutBytes(const void* const pBuf, const int size)
 	{
 		#ifndef NDEBUG
 		AssertSize(size);
 		#endif
 
-		const int oldSize = mSize, newSize = oldSize + size;
-		const int delta = newSize > mBytes.GetSize() ? 0 : size;
+		// Write large data directly to stream.
+		if (mpStream && size > mBytes.GetSize())
+		{
+			return FlushStream() && mpStream->Write(pBuf, size) ? size : 0;
+		}
+
+		const int delta = Fits(size) ? size : 0;
+		const int oldSize = mSize, newSize = oldSize + delta;
 
 		if (delta)
 		{
@@ -41,8 +168,8 @@ public:
 		AssertSize(size);
 		#endif
 
-		const int oldSize = mSize, newSize = oldSize + size;
-		const int delta = newSize > mBytes.GetSize() ? 0 : size;
+		const int delta = Fits(size) ? size : 0;
+		const int oldSize = mSize, newSize = oldSize + delta;
 
 		if (delta)
 		{
@@ -55,20 +182,27 @@ public:
 
 	int GetBytes(void* const pBuf, const int size, const int startPos) const
 	{
+		if (mpStream) return mpStream->GetBytes(pBuf, size, startPos);
+
 		int endPos = startPos + size;
-		if (startPos >= 0 && endPos <= mBytes.GetSize())
-			memcpy(pBuf, (const char*)mBytes.GetFast() + startPos, size);
+		const char* const pBytes = GetData(startPos, size);
+
+		if (pBytes)
+			memcpy(pBuf, pBytes, size);
 		else
 			endPos = -1;
 
 		return endPos;
 	}
 
+	// If streaming, then buffer is only valid until next Get*().
 	int GetBuf(const void** const ppBuf, const int size, const int startPos) const
 	{
 		int endPos = startPos + size;
-		if (startPos >= 0 && endPos <= mBytes.GetSize())
-			*ppBuf = (const char*)mBytes.GetFast() + startPos;
+		const char* const pBytes = GetData(startPos, size);
+
+		if (pBytes)
+			*ppBuf = pBytes;
 		else
 			endPos = -1;
 
@@ -129,8 +263,8 @@ public:
 		AssertSize(delta);
 		#endif
 
+		delta = Fits(delta) ? delta : 0;
 		const int oldSize = mSize, newSize = oldSize + delta;
-		delta = newSize > mBytes.GetSize() ? 0 : delta;
 
 		if (delta)
 		{
@@ -153,15 +287,17 @@ public:
 		int endPos = -1;
 
 		const int strStartPos = startPos + (int)sizeof(int);
-		if (startPos >= 0 && strStartPos <= mBytes.GetSize())
+		const char* pBytes = GetData(startPos, (int)sizeof(int));
+
+		if (pBytes)
 		{
-			const char* const pBytes = (const char*)mBytes.GetFast();
-			const int len = GetStrLen(pBytes + startPos);
+			const int len = GetStrLen(pBytes);
+			pBytes = GetData(strStartPos, len);
 
 			const int strEndPos = strStartPos + len;
-			if (strEndPos <= mBytes.GetSize() && len < bufSize)
+			if (pBytes && len < bufSize)
 			{
-				memcpy(pBuf, pBytes + strStartPos, len);
+				memcpy(pBuf, pBytes, len);
 				pBuf[len] = 0;
 
 				endPos = strEndPos;
@@ -176,15 +312,17 @@ public:
 		int endPos = -1;
 
 		const int strStartPos = startPos + (int)sizeof(int);
-		if (startPos >= 0 && strStartPos <= mBytes.GetSize())
+		const char* pBytes = GetData(startPos, (int)sizeof(int));
+
+		if (pBytes)
 		{
-			const char* const pBytes = (const char*)mBytes.GetFast();
-			const int len = GetStrLen(pBytes + startPos);
+			const int len = GetStrLen(pBytes);
+			pBytes = GetData(strStartPos, len);
 
 			const int strEndPos = strStartPos + len;
-			if (strEndPos <= mBytes.GetSize() && pStr->SetLen(len))
+			if (pBytes && pStr->SetLen(len))
 			{
-				memcpy(pStr->Get(), pBytes + strStartPos, len);
+				memcpy(pStr->Get(), pBytes, len);
 				endPos = strEndPos;
 			}
 		}
@@ -197,15 +335,17 @@ public:
 		int endPos = -1;
 
 		const int strStartPos = startPos + (int)sizeof(int);
-		if (startPos >= 0 && strStartPos <= mBytes.GetSize())
+		const char* pBytes = GetData(startPos, (int)sizeof(int));
+
+		if (pBytes)
 		{
-			const char* const pBytes = (const char*)mBytes.GetFast();
-			const int len = GetStrLen(pBytes + startPos);
+			const int len = GetStrLen(pBytes);
+			pBytes = GetData(strStartPos, len);
 
 			const int strEndPos = strStartPos + len;
-			if (strEndPos <= mBytes.GetSize())
+			if (pBytes)
 			{
-				pStr->SetRaw(pBytes + strStartPos, len);
+				pStr->SetRaw(pBytes, len);
 				endPos = pStr->GetLength() == len ? strEndPos : endPos;
 			}
 		}
@@ -224,7 +364,7 @@ public:
 		AssertSize(1);
 		#endif
 
-		const int delta = mSize < mBytes.GetSize();
+		const int delta = Fits(1);
 		if (delta) *((char*)mBytes.GetFast() + mSize++) = (char)byte;
 
 		return delta;
@@ -238,8 +378,8 @@ public:
 		AssertSize(delta);
 		#endif
 
+		delta = Fits(delta) ? delta : 0;
 		const int oldSize = mSize, newSize = oldSize + delta;
-		delta = newSize > mBytes.GetSize() ? 0 : delta;
 
 		if (delta)
 		{
@@ -269,8 +409,8 @@ public:
 		AssertSize(delta);
 		#endif
 
+		delta = Fits(delta) ? delta : 0;
 		const int oldSize = mSize, newSize = oldSize + delta;
-		delta = newSize > mBytes.GetSize() ? 0 : delta;
 
 		if (delta)
 		{
@@ -304,8 +444,10 @@ public:
 	int GetBool(bool* const pB, const int startPos) const
 	{
 		int endPos = startPos + 1;
-		if (startPos >= 0 && startPos < mBytes.GetSize())
-			*pB = !!*((const char*)mBytes.GetFast() + startPos);
+		const char* const pBytes = GetData(startPos, 1);
+
+		if (pBytes)
+			*pB = !!*pBytes;
 		else
 			endPos = -1;
 
@@ -315,8 +457,10 @@ public:
 	int GetByte(char* const pVal, const int startPos) const
 	{
 		int endPos = startPos + 1;
-		if (startPos >= 0 && startPos < mBytes.GetSize())
-			*pVal = *((const char*)mBytes.GetFast() + startPos);
+		const char* const pBytes = GetData(startPos, 1);
+
+		if (pBytes)
+			*pVal = *pBytes;
 		else
 			endPos = -1;
 
@@ -326,10 +470,12 @@ public:
 	template <class T> int GetInt(T* const pVal, const int startPos) const
 	{
 		int endPos = startPos + (int)sizeof(T);
-		if (startPos >= 0 && endPos <= mBytes.GetSize())
+		const char* const pBytes = GetData(startPos, (int)sizeof(T));
+
+		if (pBytes)
 		{
 			T n;
-			memcpy(&n, (const char*)mBytes.GetFast() + startPos, sizeof(T));
+			memcpy(&n, pBytes, sizeof(T));
 
 			#ifdef WDL_BIG_ENDIAN
 			n = WDL_bswap_if_be(n);
@@ -354,8 +500,10 @@ public:
 	template <class T> int GetFloat(T* const pVal, const int startPos) const
 	{
 		int endPos = startPos + (int)sizeof(T);
-		if (startPos >= 0 && endPos <= mBytes.GetSize())
-			memcpy(pVal, (const char*)mBytes.GetFast() + startPos, sizeof(T));
+		const char* const pBytes = GetData(startPos, (int)sizeof(T));
+
+		if (pBytes)
+			memcpy(pVal, pBytes, sizeof(T));
 		else
 			endPos = -1;
 
@@ -404,6 +552,25 @@ public:
 		return mBytes.GetSize();
 	}
 
+	// Reserves room for at least size bytes (e.g. before putting lots of
+	// data in growable chunk), but doesn't change data size. Returns new
+	// allocated size.
+	int Reserve(const int size)
+	{
+		if (size > mBytes.GetSize()) mBytes.Resize(size, false);
+		return mBytes.GetSize();
+	}
+
+	// Frees unused memory, but only if more than half of allocated size is
+	// unused (so shrinking and regrowing doesn't thrash). Returns new
+	// allocated size.
+	int Shrink()
+	{
+		const int allocSize = mBytes.GetSize();
+		if (mSize < allocSize >> 1) mBytes.Resize(mSize, true);
+		return mBytes.GetSize();
+	}
+
 	inline void Clear()
 	{
 		mSize = 0;
@@ -411,6 +578,7 @@ public:
 
 	inline int Size() const
 	{
+		assert(!mpStream);
 		return mSize;
 	}
 
@@ -437,19 +605,21 @@ public:
 
 	inline void* GetBytes()
 	{
+		assert(!mpStream);
 		return mBytes.Get();
 	}
 
 	inline const void* GetBytes() const
 	{
-		return mBytes.Get();
+		assert(!mpStream);
+		return mpView ? mpView : mBytes.Get();
 	}
 
 	bool IsEqual(const ByteChunk* const pRHS) const
 	{
 		if (!pRHS) return false;
 
-		const void* const ptr1 = mBytes.Get();
+		const void* const ptr1 = GetBytes();
 		const void* const ptr2 = pRHS->GetBytes();
 
 		if (!((INT_PTR)ptr1 & (INT_PTR)ptr2) || (pRHS->Size() != mSize)) return false;
@@ -458,6 +628,25 @@ public:
 	}
 
 protected:
+	// Returns data that Get*() read from (either owned, view, or stream),
+	// or NULL if out of bounds.
+	const char* GetData(const int startPos, const int size) const
+	{
+		if (mpStream) return mpStream->GetData(startPos, size);
+
+		const char* const pData = mpView ? mpView : (const char*)mBytes.GetFast();
+		const int dataSize = mpView ? mSize : mBytes.GetSize();
+
+		return startPos >= 0 && size >= 0 && startPos + size <= dataSize ? pData + startPos : NULL;
+	}
+
+	inline void SetView(const void* const pData, const int size)
+	{
+		mpView = (const char*)pData;
+		mSize = pData ? size : 0;
+		mGrowable = false;
+	}
+
 	static void PutStrLen(char* const pBytes, int len)
 	{
 		#ifdef WDL_BIG_ENDIAN
@@ -479,16 +668,117 @@ protected:
 		return len;
 	}
 
+	// Returns true if size more bytes fit, writing data to stream if
+	// streaming, or else growing allocated size if growable.
+	inline bool Fits(const int size)
+	{
+		const int newSize = mSize + size;
+		if (newSize <= mBytes.GetSize()) return true;
+		return mpStream ? FlushStream() && size <= mBytes.GetSize() : mGrowable && Grow(newSize);
+	}
+
+	bool Grow(const int newSize)
+	{
+		if (newSize < 0) return false;
+		const int allocSize = mBytes.GetSize();
+
+		// Grow by 1.5x (or more, if needed), guarding against overflow.
+		int size = allocSize < 0x50000000 ? allocSize + (allocSize >> 1) : newSize;
+		size = wdl_max(wdl_max(size, newSize), kDefaultSize);
+
+		return !!mBytes.ResizeOK(size, false);
+	}
+
 	#ifndef NDEBUG
 	void AssertSize(const int size) const
 	{
 		// Oops, should have allocated larger size.
-		const bool notEnoughAllocated = mSize + size <= mBytes.GetSize();
+		const bool notEnoughAllocated = mGrowable || mpStream || mSize + size <= mBytes.GetSize();
 		assert(notEnoughAllocated);
 	}
 	#endif
 
 private:
 	WDL_HeapBuf mBytes;
+	const char* mpView;
+	ByteChunkStream* mpStream;
 	int mSize;
+	bool mGrowable;
+};
+
+// Non-owning, read-only view of memory owned by someone else (e.g. host),
+// so it can be passed to Unserialize*() without copying. The memory
+// should stay valid for as long as the view is used.
+
+class ByteChunkView: public ByteChunk
+{
+public:
+	ByteChunkView(const void* const pData = NULL, const int size = 0) { Set(pData, size); }
+
+	inline void Set(const void* const pData, const int size) { SetView(pData, size); }
+
+	inline const void* GetBytes() const { return ByteChunk::GetBytes(); }
+};
+
+// Bounded single producer, single consumer queue, which is wait-free for
+// both producer and consumer (e.g. to pass data from GUI to audio thread).
+// T should be plain old data.
+
+template <class T>
+class ILockFreeQueue
+{
+public:
+	ILockFreeQueue(): mSize(0), mRead(0), mWrite(0) {}
+	~ILockFreeQueue() {}
+
+	// Not thread-safe, so call before using queue. Rounds up size to power
+	// of 2, returns new size (or 0 if out of memory).
+	int Resize(const int size)
+	{
+		int n = 1;
+		while (n < size) n <<= 1;
+
+		mSize = mBuf.ResizeOK(n) ? n : 0;
+		mRead.store(0, std::memory_order_relaxed);
+		mWrite.store(0, std::memory_order_relaxed);
+
+		return (int)mSize;
+	}
+
+	inline int GetSize() const { return (int)mSize; }
+
+	// Producer: Adds item at back of queue, returns false if queue is full.
+	bool Push(const T& item)
+	{
+		const unsigned int w = mWrite.load(std::memory_order_relaxed);
+		const unsigned int r = mRead.load(std::memory_order_acquire);
+		if (w - r >= mSize) return false;
+
+		mBuf.Get()[w & (mSize - 1)] = item;
+		mWrite.store(w + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer: Removes item from front of queue, returns false if queue
+	// is empty.
+	bool Pop(T* const pItem)
+	{
+		const unsigned int r = mRead.load(std::memory_order_relaxed);
+		if (r == mWrite.load(std::memory_order_acquire)) return false;
+
+		*pItem = mBuf.Get()[r & (mSize - 1)];
+		mRead.store(r + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer: Returns true if queue is empty.
+	inline bool Empty() const
+	{
+		return mRead.load(std::memory_order_relaxed) == mWrite.load(std::memory_order_acquire);
+	}
+
+private:
+	WDL_TypedBuf<T> mBuf;
+	unsigned int mSize;
+	std::atomic<unsigned int> mRead, mWrite;
 };
@@ -11,6 +11,9 @@
 #elif defined(__APPLE__)
 	#define MAC_ONLY(idx, str) { idx, str },
 	#define WIN_ONLY(idx, str)
+#else
+	#define WIN_ONLY(idx, str)
+	#define MAC_ONLY(idx, str)
 #endif
 
 struct LookUpTbl
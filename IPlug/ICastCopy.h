@@ -0,0 +1,198 @@
+#pragma once
+
+// SIMD kernels for the float <-> double sample conversions (and float
+// accumulation) done by IPlugBase::CastCopy() and CastCopyAccumulating().
+// Kernels process blocks
+// of 4 (SSE2, NEON) or 8 (AVX) samples, and return number of samples
+// processed, so caller can finish remaining samples.
+
+// Define IPLUG_NO_SIMD to always use plain C++ float <-> double conversion.
+#ifndef IPLUG_NO_SIMD
+	#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+		#define IPLUG_SIMD_SSE2
+		#include <emmintrin.h>
+
+		#if defined(_MSC_VER)
+			#define IPLUG_SIMD_AVX
+			#define IPLUG_TARGET_AVX
+			#include <immintrin.h>
+			#include <intrin.h>
+		#elif defined(__GNUC__)
+			#define IPLUG_SIMD_AVX
+			#define IPLUG_TARGET_AVX __attribute__((target("avx")))
+			#include <immintrin.h>
+		#endif
+	#elif defined(_M_ARM64) || defined(__aarch64__)
+		#define IPLUG_SIMD_NEON
+		#include <arm_neon.h>
+	#endif
+#endif
+
+#ifdef IPLUG_SIMD_SSE2
+
+static inline int CastFloatToDoubleSSE2(double* const pDest, const float* const pSrc, const int n)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(&pSrc[i]);
+		_mm_storeu_pd(&pDest[i], _mm_cvtps_pd(x));
+		_mm_storeu_pd(&pDest[i + 2], _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+	}
+	return i;
+}
+
+static inline int CastDoubleToFloatSSE2(float* const pDest, const double* const pSrc, const int n)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m128 a = _mm_cvtpd_ps(_mm_loadu_pd(&pSrc[i]));
+		const __m128 b = _mm_cvtpd_ps(_mm_loadu_pd(&pSrc[i + 2]));
+		_mm_storeu_ps(&pDest[i], _mm_movelh_ps(a, b));
+	}
+	return i;
+}
+
+static inline int CastDoubleToFloatAccumulatingSSE2(float* const pDest, const double* const pSrc, const int n)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m128 a = _mm_cvtpd_ps(_mm_loadu_pd(&pSrc[i]));
+		const __m128 b = _mm_cvtpd_ps(_mm_loadu_pd(&pSrc[i + 2]));
+		_mm_storeu_ps(&pDest[i], _mm_add_ps(_mm_loadu_ps(&pDest[i]), _mm_movelh_ps(a, b)));
+	}
+	return i;
+}
+
+static inline int CastFloatToFloatAccumulatingSSE2(float* const pDest, const float* const pSrc, const int n)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		_mm_storeu_ps(&pDest[i], _mm_add_ps(_mm_loadu_ps(&pDest[i]), _mm_loadu_ps(&pSrc[i])));
+	}
+	return i;
+}
+
+#endif // IPLUG_SIMD_SSE2
+
+#ifdef IPLUG_SIMD_AVX
+
+// Checks for OSXSAVE and AVX, then if OS saves YMM registers.
+static inline bool CPUHasAVX()
+{
+	#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+
+	const int avx = (1 << 27) | (1 << 28);
+	return (info[2] & avx) == avx && (_xgetbv(0) & 6) == 6;
+	#else
+	__builtin_cpu_init();
+	return !!__builtin_cpu_supports("avx");
+	#endif
+}
+
+// Only call these if CPUHasAVX().
+
+IPLUG_TARGET_AVX static inline int CastFloatToDoubleAVX(double* const pDest, const float* const pSrc, const int n)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		const __m128 a = _mm_loadu_ps(&pSrc[i]);
+		const __m128 b = _mm_loadu_ps(&pSrc[i + 4]);
+		_mm256_storeu_pd(&pDest[i], _mm256_cvtps_pd(a));
+		_mm256_storeu_pd(&pDest[i + 4], _mm256_cvtps_pd(b));
+	}
+	return i;
+}
+
+IPLUG_TARGET_AVX static inline int CastDoubleToFloatAVX(float* const pDest, const double* const pSrc, const int n)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		const __m256d a = _mm256_loadu_pd(&pSrc[i]);
+		const __m256d b = _mm256_loadu_pd(&pSrc[i + 4]);
+		_mm_storeu_ps(&pDest[i], _mm256_cvtpd_ps(a));
+		_mm_storeu_ps(&pDest[i + 4], _mm256_cvtpd_ps(b));
+	}
+	return i;
+}
+
+IPLUG_TARGET_AVX static inline int CastDoubleToFloatAccumulatingAVX(float* const pDest, const double* const pSrc, const int n)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		const __m128 a = _mm256_cvtpd_ps(_mm256_loadu_pd(&pSrc[i]));
+		const __m128 b = _mm256_cvtpd_ps(_mm256_loadu_pd(&pSrc[i + 4]));
+		_mm_storeu_ps(&pDest[i], _mm_add_ps(_mm_loadu_ps(&pDest[i]), a));
+		_mm_storeu_ps(&pDest[i + 4], _mm_add_ps(_mm_loadu_ps(&pDest[i + 4]), b));
+	}
+	return i;
+}
+
+IPLUG_TARGET_AVX static inline int CastFloatToFloatAccumulatingAVX(float* const pDest, const float* const pSrc, const int n)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		_mm256_storeu_ps(&pDest[i], _mm256_add_ps(_mm256_loadu_ps(&pDest[i]), _mm256_loadu_ps(&pSrc[i])));
+	}
+	return i;
+}
+
+#endif // IPLUG_SIMD_AVX
+
+#ifdef IPLUG_SIMD_NEON
+
+static inline int CastFloatToDoubleNEON(double* const pDest, const float* const pSrc, const int n)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const float32x4_t x = vld1q_f32(&pSrc[i]);
+		vst1q_f64(&pDest[i], vcvt_f64_f32(vget_low_f32(x)));
+		vst1q_f64(&pDest[i + 2], vcvt_high_f64_f32(x));
+	}
+	return i;
+}
+
+static inline int CastDoubleToFloatNEON(float* const pDest, const double* const pSrc, const int n)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const float32x2_t a = vcvt_f32_f64(vld1q_f64(&pSrc[i]));
+		vst1q_f32(&pDest[i], vcvt_high_f32_f64(a, vld1q_f64(&pSrc[i + 2])));
+	}
+	return i;
+}
+
+static inline int CastDoubleToFloatAccumulatingNEON(float* const pDest, const double* const pSrc, const int n)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const float32x2_t a = vcvt_f32_f64(vld1q_f64(&pSrc[i]));
+		const float32x4_t x = vcvt_high_f32_f64(a, vld1q_f64(&pSrc[i + 2]));
+		vst1q_f32(&pDest[i], vaddq_f32(vld1q_f32(&pDest[i]), x));
+	}
+	return i;
+}
+
+static inline int CastFloatToFloatAccumulatingNEON(float* const pDest, const float* const pSrc, const int n)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		vst1q_f32(&pDest[i], vaddq_f32(vld1q_f32(&pDest[i]), vld1q_f32(&pSrc[i])));
+	}
+	return i;
+}
+
+#endif // IPLUG_SIMD_NEON
@@ -0,0 +1,496 @@
+#pragma once
+
+// Fast LZ compression for state and bank chunks. Compressed chunks start
+// with a magic number, followed by independently compressed blocks of
+// up to kBlockSize bytes, so they can also be (de)compressed while
+// streaming. Chunks without magic number are left as is, so older
+// uncompressed chunks still load.
+//
+// Wrappers always decompress chunks when loading, but only compress
+// chunks when saving if IPLUG_COMPRESS_STATE is defined (older plugin
+// versions can't load compressed chunks).
+//
+// Container format (little endian):
+//   int32 magic
+//   Blocks: int32 raw size, int32 stored size (== raw size if stored
+//   uncompressed), stored data
+//   int32 0 (end)
+//
+// Block format (LZ4-like) is a sequence of: Token byte (high nibble =
+// literal length, low nibble = match length - 4, 15 = add next bytes
+// until one < 255), literals, and 16-bit match offset. The last sequence
+// only has literals.
+
+#include <string.h>
+
+#include "Containers.h"
+
+#include "WDL/wdltypes.h"
+
+class IChunkCodec
+{
+public:
+	static const int kMagic = 0x49504C5A; // 'IPLZ'
+	static const int kBlockSize = 0x10000;
+
+	// Worst case compressed block size.
+	static inline int MaxCompressedSize(const int size) { return size + size / 255 + 16; }
+
+	// Returns compressed size, or 0 if it doesn't fit in destSize.
+	static int CompressBlock(const unsigned char* const src, const int srcSize, unsigned char* const dest, const int destSize)
+	{
+		static const int kHashBits = 12, kMinMatch = 4, kLastLiterals = 5;
+
+		int table[1 << kHashBits];
+		for (int i = 0; i < 1 << kHashBits; ++i) table[i] = -1;
+
+		int ip = 0, anchor = 0, op = 0;
+		const int matchLimit = srcSize - kLastLiterals;
+
+		while (ip < matchLimit - kMinMatch)
+		{
+			const unsigned int seq = Read32(src + ip);
+			const int h = (int)((seq * 2654435761u) >> (32 - kHashBits));
+
+			const int ref = table[h];
+			table[h] = ip;
+
+			if (ref < 0 || ip - ref > 0xFFFF || Read32(src + ref) != seq)
+			{
+				++ip;
+				continue;
+			}
+
+			int len = kMinMatch;
+			while (ip + len < matchLimit && src[ref + len] == src[ip + len]) ++len;
+
+			op = PutSequence(dest, op, destSize, src + anchor, ip - anchor, len - kMinMatch, ip - ref);
+			if (op < 0) return 0;
+
+			ip += len;
+			anchor = ip;
+		}
+
+		op = PutSequence(dest, op, destSize, src + anchor, srcSize - anchor, 0, 0);
+		return op < 0 ? 0 : op;
+	}
+
+	// Returns decompressed size, or -1 if data is corrupt or doesn't fit
+	// in destSize.
+	static int DecompressBlock(const unsigned char* const src, const int srcSize, unsigned char* const dest, const int destSize)
+	{
+		int ip = 0, op = 0;
+
+		while (ip < srcSize)
+		{
+			const int token = src[ip++];
+
+			int n = token >> 4;
+			if (n == 15 && (ip = GetLength(src, ip, srcSize, &n)) < 0) return -1;
+
+			if (n > srcSize - ip || n > destSize - op) return -1;
+			memcpy(dest + op, src + ip, n);
+			ip += n;
+			op += n;
+
+			// Last sequence.
+			if (ip == srcSize) break;
+
+			if (srcSize - ip < 2) return -1;
+			const int ofs = src[ip] | (src[ip + 1] << 8);
+			ip += 2;
+
+			int len = token & 15;
+			if (len == 15 && (ip = GetLength(src, ip, srcSize, &len)) < 0) return -1;
+			len += 4;
+
+			if (!ofs || ofs > op || len > destSize - op) return -1;
+
+			// Byte by byte, because match can overlap.
+			const unsigned char* pRef = dest + op - ofs;
+			for (int i = 0; i < len; ++i) dest[op + i] = pRef[i];
+			op += len;
+		}
+
+		return op;
+	}
+
+	// Returns true if chunk data from startPos is compressed.
+	static bool IsCompressed(const ByteChunk* const pChunk, const int startPos = 0)
+	{
+		int magic;
+		return pChunk->GetInt32(&magic, startPos) >= 0 && magic == kMagic;
+	}
+
+	// Compresses chunk data from startPos into pDest (appending to
+	// existing data), returns false on error.
+	static bool Compress(const ByteChunk* const pSrc, const int startPos, ByteChunk* const pDest)
+	{
+		WDL_TypedBuf<unsigned char> buf;
+		if (!buf.ResizeOK(MaxCompressedSize(kBlockSize))) return false;
+
+		const unsigned char* const src = (const unsigned char*)pSrc->GetBytes() + startPos;
+		const int size = pSrc->Size() - startPos;
+
+		if (!pDest->PutInt32(kMagic)) return false;
+
+		for (int pos = 0; pos < size; pos += kBlockSize)
+		{
+			if (!PutBlock(pDest, src + pos, wdl_min(size - pos, kBlockSize), buf.Get(), buf.GetSize())) return false;
+		}
+
+		return !!pDest->PutInt32(0);
+	}
+
+	// Compresses chunk data from startPos in place, but only if it gets
+	// smaller. Returns false on error.
+	static bool CompressInPlace(ByteChunk* const pChunk, const int startPos = 0)
+	{
+		ByteChunk temp;
+		temp.SetGrowable();
+
+		if (!temp.Alloc(wdl_max(pChunk->Size() / 2, (int)ByteChunk::kDefaultSize)) ||
+			!Compress(pChunk, startPos, &temp)) return false;
+
+		if (temp.Size() < pChunk->Size() - startPos)
+		{
+			pChunk->Resize(startPos);
+			pChunk->PutChunk(&temp);
+		}
+
+		return true;
+	}
+
+	// Decompresses chunk data from startPos, returns end position, or -1
+	// on error.
+	static int Decompress(const ByteChunk* const pSrc, int pos, ByteChunk* const pDest)
+	{
+		int magic;
+		pos = pSrc->GetInt32(&magic, pos);
+		if (pos < 0 || magic != kMagic) return -1;
+
+		for (;;)
+		{
+			int rawSize, storedSize;
+			pos = pSrc->GetInt32(&rawSize, pos);
+			if (pos < 0) return -1;
+			if (!rawSize) break;
+
+			pos = pSrc->GetInt32(&storedSize, pos);
+			if (pos < 0 || rawSize < 0 || rawSize > kBlockSize || storedSize < 0 || storedSize > rawSize) return -1;
+
+			const void* pStored;
+			pos = pSrc->GetBuf(&pStored, storedSize, pos);
+			if (pos < 0) return -1;
+
+			void* pRaw;
+			if (pDest->PutBuf(&pRaw, rawSize) != rawSize) return -1;
+
+			if (storedSize == rawSize)
+				memcpy(pRaw, pStored, rawSize);
+			else if (DecompressBlock((const unsigned char*)pStored, storedSize, (unsigned char*)pRaw, rawSize) != rawSize)
+				return -1;
+		}
+
+		return pos;
+	}
+
+	// If chunk is compressed, then decompresses it into pTemp, and returns
+	// pTemp. Else (or on error) returns pChunk.
+	static const ByteChunk* DecompressIfCompressed(const ByteChunk* const pChunk, ByteChunk* const pTemp)
+	{
+		if (!IsCompressed(pChunk)) return pChunk;
+
+		pTemp->SetGrowable();
+		pTemp->Alloc(wdl_max(pChunk->Size() * 2, (int)ByteChunk::kDefaultSize));
+
+		return Decompress(pChunk, 0, pTemp) >= 0 ? pTemp : pChunk;
+	}
+
+	// Compresses block, and puts it in chunk.
+	static bool PutBlock(ByteChunk* const pDest, const unsigned char* const src, const int size, unsigned char* const buf, const int bufSize)
+	{
+		const int n = CompressBlock(src, size, buf, wdl_min(bufSize, size - 1));
+		const bool stored = n <= 0;
+
+		return pDest->PutInt32(size) && pDest->PutInt32(stored ? size : n) &&
+			pDest->PutBytes(stored ? src : buf, stored ? size : n) == (stored ? size : n);
+	}
+
+protected:
+	static inline unsigned int Read32(const unsigned char* const p)
+	{
+		unsigned int x;
+		memcpy(&x, p, sizeof(x));
+		return x;
+	}
+
+	static int PutLength(unsigned char* const dest, int op, const int destSize, int n)
+	{
+		for (; n >= 255; n -= 255)
+		{
+			if (op >= destSize) return -1;
+			dest[op++] = 255;
+		}
+
+		if (op >= destSize) return -1;
+		dest[op++] = (unsigned char)n;
+
+		return op;
+	}
+
+	static int GetLength(const unsigned char* const src, int ip, const int srcSize, int* const pLen)
+	{
+		int b;
+		do
+		{
+			if (ip >= srcSize || *pLen > kBlockSize) return -1;
+			*pLen += b = src[ip++];
+		}
+		while (b == 255);
+
+		return ip;
+	}
+
+	// Returns new output position, or -1 if it doesn't fit.
+	static int PutSequence(unsigned char* const dest, int op, const int destSize,
+		const unsigned char* const literals, const int nLiterals, const int matchLen, const int ofs)
+	{
+		if (op >= destSize) return -1;
+		const int tokenPos = op++;
+
+		dest[tokenPos] = (unsigned char)((wdl_min(nLiterals, 15) << 4) | wdl_min(matchLen, 15));
+
+		if (nLiterals >= 15 && (op = PutLength(dest, op, destSize, nLiterals - 15)) < 0) return -1;
+
+		if (nLiterals > destSize - op) return -1;
+		memcpy(dest + op, literals, nLiterals);
+		op += nLiterals;
+
+		// Last sequence.
+		if (!ofs) return op;
+
+		if (destSize - op < 2) return -1;
+		dest[op++] = (unsigned char)ofs;
+		dest[op++] = (unsigned char)(ofs >> 8);
+
+		if (matchLen >= 15 && (op = PutLength(dest, op, destSize, matchLen - 15)) < 0) return -1;
+
+		return op;
+	}
+};
+
+// Compresses data written to stream, or decompresses data read from
+// stream (see ByteChunk::SetStream()). Uncompressed data is read as is,
+// also if it happens to start with magic number, but isn't followed by
+// valid block header.
+
+class IChunkCodecStream: public ByteChunkStream
+{
+public:
+	IChunkCodecStream(ByteChunkStream* const pStream): mpStream(pStream), mRawPos(0), mRawSize(0), mState(kStateStart) {}
+
+	// Writes remaining data, and end marker.
+	bool Finish()
+	{
+		unsigned char end[4];
+		PutInt32(end, 0);
+
+		return (mState != kStateStart || WriteMagic()) && WriteBlock() && mpStream->Write(end, sizeof(end));
+	}
+
+	bool Write(const void* const pBuf, const int size)
+	{
+		if (mState == kStateStart && !WriteMagic()) return false;
+
+		for (int n = 0; n < size;)
+		{
+			if (mRawSize == IChunkCodec::kBlockSize && !WriteBlock()) return false;
+
+			const int m = wdl_min(size - n, IChunkCodec::kBlockSize - mRawSize);
+			if (!mRaw.ResizeOK(IChunkCodec::kBlockSize, false)) return false;
+
+			memcpy(mRaw.Get() + mRawSize, (const char*)pBuf + n, m);
+			mRawSize += m;
+			n += m;
+		}
+
+		return true;
+	}
+
+	int Read(void* const pBuf, const int size)
+	{
+		if (mState == kStateStart && !ReadMagic()) return -1;
+		if (mState == kStateStored && mRawPos >= mRawSize) return mpStream->Read(pBuf, size);
+
+		if (mRawPos >= mRawSize && (mState == kStateEnd || !ReadBlock())) return mState == kStateEnd ? 0 : -1;
+
+		const int n = wdl_min(size, mRawSize - mRawPos);
+		memcpy(pBuf, mRaw.Get() + mRawPos, n);
+		mRawPos += n;
+
+		return n;
+	}
+
+protected:
+	enum EState
+	{
+		kStateStart = 0,
+		kStateCompressed,
+		kStateStored, // Uncompressed data, read as is.
+		kStateEnd
+	};
+
+	static inline void PutInt32(unsigned char* const p, const int n)
+	{
+		for (int i = 0; i < 4; ++i) p[i] = (unsigned char)((unsigned int)n >> (i * 8));
+	}
+
+	static inline int GetInt32(const unsigned char* const p)
+	{
+		return (int)((unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24));
+	}
+
+	// Reads size bytes, returns number of bytes read (only < size at end
+	// of stream), or -1 on error.
+	int ReadAll(void* const pBuf, const int size)
+	{
+		int n = 0;
+		while (n < size)
+		{
+			const int m = mpStream->Read((char*)pBuf + n, size - n);
+			if (m < 0) return -1;
+			if (!m) break;
+			n += m;
+		}
+		return n;
+	}
+
+	bool WriteMagic()
+	{
+		mState = kStateCompressed;
+		mRawSize = 0;
+
+		unsigned char magic[4];
+		PutInt32(magic, IChunkCodec::kMagic);
+
+		return mpStream->Write(magic, sizeof(magic));
+	}
+
+	bool WriteBlock()
+	{
+		const int size = mRawSize;
+		if (!size) return true;
+		mRawSize = 0;
+
+		// Block header, followed by compressed (or else stored) data.
+		unsigned char* const buf = mBlock.ResizeOK(8 + IChunkCodec::MaxCompressedSize(IChunkCodec::kBlockSize), false);
+		if (!buf) return false;
+
+		int n = IChunkCodec::CompressBlock(mRaw.Get(), size, buf + 8, size - 1);
+		if (n <= 0)
+		{
+			n = size;
+			memcpy(buf + 8, mRaw.Get(), size);
+		}
+
+		PutInt32(buf, size);
+		PutInt32(buf + 4, n);
+
+		return mpStream->Write(buf, 8 + n);
+	}
+
+	// Reads magic number and first block. If these aren't valid, then data
+	// isn't compressed after all.
+	bool ReadMagic()
+	{
+		unsigned char buf[12];
+		const int n = ReadAll(buf, 12);
+		if (n < 0) return false;
+
+		int nStored = 0;
+		if (n >= 8 && GetInt32(buf) == IChunkCodec::kMagic)
+		{
+			// Empty.
+			if (n == 8 && !GetInt32(buf + 4))
+			{
+				mState = kStateEnd;
+				return true;
+			}
+
+			if (n == 12 && IsValidBlockHeader(buf + 4))
+			{
+				mState = kStateCompressed;
+				if (ReadBlockData(buf + 4, &nStored)) return true;
+				if (nStored < 0) return false;
+			}
+		}
+
+		// Not compressed, so return bytes already read first.
+		mState = kStateStored;
+
+		// Block data (if any) is in mRaw if stored uncompressed, else in
+		// mStored.
+		const bool inRaw = nStored && GetInt32(buf + 4) == GetInt32(buf + 8);
+		if (!mRaw.ResizeOK(12 + nStored, false)) return false;
+
+		unsigned char* const pRaw = mRaw.Get();
+		if (nStored) memmove(pRaw + n, inRaw ? pRaw : mStored.Get(), nStored);
+		memcpy(pRaw, buf, n);
+
+		mRawPos = 0;
+		mRawSize = n + nStored;
+
+		return true;
+	}
+
+	static bool IsValidBlockHeader(const unsigned char* const hdr)
+	{
+		const int rawSize = GetInt32(hdr);
+		const int storedSize = GetInt32(hdr + 4);
+
+		return rawSize > 0 && rawSize <= IChunkCodec::kBlockSize && storedSize > 0 && storedSize <= rawSize;
+	}
+
+	bool ReadBlock()
+	{
+		unsigned char hdr[8];
+		if (ReadAll(hdr, 4) != 4) return false;
+
+		if (!GetInt32(hdr))
+		{
+			mState = kStateEnd;
+			return false;
+		}
+
+		int nStored;
+		return ReadAll(hdr + 4, 4) == 4 && IsValidBlockHeader(hdr) && ReadBlockData(hdr, &nStored);
+	}
+
+	// Reads (and decompresses) data of block with given header. Also
+	// returns number of stored bytes read, or -1 on read error.
+	bool ReadBlockData(const unsigned char* const hdr, int* const pNStored)
+	{
+		const int rawSize = GetInt32(hdr);
+		const int storedSize = GetInt32(hdr + 4);
+
+		*pNStored = 0;
+		if (!mRaw.ResizeOK(IChunkCodec::kBlockSize, false) || !mStored.ResizeOK(IChunkCodec::kBlockSize, false)) return false;
+
+		unsigned char* const pStored = storedSize == rawSize ? mRaw.Get() : mStored.Get();
+		if ((*pNStored = ReadAll(pStored, storedSize)) != storedSize) return false;
+
+		if (pStored != mRaw.Get() && IChunkCodec::DecompressBlock(pStored, storedSize, mRaw.Get(), rawSize) != rawSize) return false;
+
+		mRawPos = 0;
+		mRawSize = rawSize;
+
+		return true;
+	}
+
+	ByteChunkStream* const mpStream;
+
+	WDL_TypedBuf<unsigned char> mRaw, mStored, mBlock;
+
+	int mRawPos, mRawSize, mState;
+};
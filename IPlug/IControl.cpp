@@ -44,6 +44,22 @@ void IControl::SetDirty(const bool pushParamToPlug)
 	}
 }
 
+void IControl::SetParamIdx(const int paramIdx)
+{
+	mParamIdx = paramIdx;
+
+	IGraphics* const pGraphics = GetGUI();
+	if (pGraphics) pGraphics->InvalidateParamControls();
+}
+
+void IControl::SetRECT(const IRECT* const pR)
+{
+	mRECT = *pR;
+
+	IGraphics* const pGraphics = GetGUI();
+	if (pGraphics) pGraphics->InvalidateControlGrid();
+}
+
 void IControl::Hide(const bool hide)
 {
 	mHide = hide;
@@ -223,6 +239,9 @@ void IBitmapControl::UpdateValue(double value)
 void IBitmapControl::SetTargetArea(const IRECT* const pR)
 {
 	mTargetRECT = *pR;
+
+	IGraphics* const pGraphics = GetGUI();
+	if (pGraphics) pGraphics->InvalidateControlGrid();
 }
 
 bool IBitmapControl::IsHit(const int x, const int y)
@@ -318,6 +337,9 @@ void IInvisibleSwitchControl::SetValue(const double value)
 void IInvisibleSwitchControl::SetTargetArea(const IRECT* const pR)
 {
 	mTargetRECT = *pR;
+
+	IGraphics* const pGraphics = GetGUI();
+	if (pGraphics) pGraphics->InvalidateControlGrid();
 }
 
 bool IInvisibleSwitchControl::IsHit(const int x, const int y)
@@ -61,8 +61,10 @@ public:
 	// Ask the IGraphics object to open an edit box so the user can enter a value for this control.
 	virtual void PromptUserInput();
 
+	// Use SetParamIdx() rather than assigning mParamIdx after control has
+	// been attached, so IGraphics updates its param to controls map.
 	inline int ParamIdx() const { return mParamIdx; }
-	inline void SetParamIdx(const int paramIdx) { mParamIdx = paramIdx; }
+	void SetParamIdx(int paramIdx);
 
 	virtual void SetValueFromPlug(double value);
 	virtual void SetValueFromUserInput(double value);
@@ -74,6 +76,11 @@ public:
 	virtual IRECT* GetTargetRECT() { return &mRECT; } // The mouse target area (default = draw area).
 	virtual void SetTargetArea(const IRECT* pR) {}
 
+	// Moves control. If you change draw or mouse target area any other way
+	// after control has been attached, then call
+	// IGraphics::InvalidateControlGrid().
+	void SetRECT(const IRECT* pR);
+
 	virtual void Hide(bool hide);
 	inline bool IsHidden() const { return mHide; }
 
@@ -94,6 +101,7 @@ public:
 	inline bool IsBypassed() const { return mBypass; }
 
 	// Override if you want the control to be hit only if a visible part of it is hit, or whatever.
+	// Should only be hit inside draw and/or mouse target area.
 	virtual bool IsHit(int x, int y);
 
 	virtual void SetDirty(bool pushParamToPlug = true);
@@ -6,49 +6,162 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+
 #include "WDL/mutex.h"
 #include "WDL/wdltypes.h"
 
 const int IGraphics::kDefaultFPS;
 
+// Default bitmap cache budget in bytes (0 = unlimited).
+#ifndef IPLUG_BITMAP_CACHE_BUDGET
+	#define IPLUG_BITMAP_CACHE_BUDGET 0
+#endif
+
 class BitmapStorage
 {
 public:
-	WDL_IntKeyedArray<LICE_IBitmap*> m_bitmaps;
+	// Bitmaps are reference counted per IGraphics instance, and bitmaps
+	// without references are evicted (least recently used first) when
+	// cache exceeds budget.
+	struct BitmapEntry
+	{
+		LICE_IBitmap* bitmap;
+		size_t bytes;
+		int refs;
+		unsigned int lastUse;
+	};
+
+	WDL_IntKeyedArray<BitmapEntry> m_bitmaps;
 	WDL_Mutex m_mutex;
 
-	BitmapStorage(): m_bitmaps(Dispose) {}
+	size_t m_bytes, m_budget;
+	unsigned int m_useCount;
+
+	BitmapStorage():
+		m_bitmaps(Dispose),
+		m_bytes(0),
+		m_budget(IPLUG_BITMAP_CACHE_BUDGET),
+		m_useCount(0)
+	{}
 
-	LICE_IBitmap* Find(const int id)
+	static size_t GetBytes(LICE_IBitmap* const bitmap)
+	{
+		return bitmap ? (size_t)bitmap->getRowSpan() * bitmap->getHeight() * sizeof(LICE_pixel) : 0;
+	}
+
+	LICE_IBitmap* Find(const int id, const bool addRef)
 	{
 		m_mutex.Enter();
-		LICE_IBitmap* const bitmap = m_bitmaps.Get(id, NULL);
+		BitmapEntry* const entry = m_bitmaps.GetPtr(id);
+		LICE_IBitmap* bitmap = NULL;
+		if (entry)
+		{
+			entry->refs += (int)addRef;
+			entry->lastUse = ++m_useCount;
+			bitmap = entry->bitmap;
+		}
 		m_mutex.Leave();
 		return bitmap;
 	}
 
-	void Add(LICE_IBitmap* const bitmap, const int id)
+	// Adds bitmap with reference, or if already in cache then deletes
+	// bitmap and returns cached bitmap.
+	LICE_IBitmap* Add(LICE_IBitmap* bitmap, const int id)
 	{
 		m_mutex.Enter();
-		m_bitmaps.Insert(id, bitmap);
+		BitmapEntry* const entry = m_bitmaps.GetPtr(id);
+		if (entry)
+		{
+			delete bitmap;
+			bitmap = entry->bitmap;
+			entry->refs++;
+			entry->lastUse = ++m_useCount;
+		}
+		else
+		{
+			BitmapEntry newEntry;
+			newEntry.bitmap = bitmap;
+			newEntry.bytes = GetBytes(bitmap);
+			newEntry.refs = 1;
+			newEntry.lastUse = ++m_useCount;
+
+			m_bitmaps.Insert(id, newEntry);
+			m_bytes += newEntry.bytes;
+			Evict();
+		}
 		m_mutex.Leave();
+		return bitmap;
 	}
 
-	/* void Remove(LICE_IBitmap* const bitmap)
+	void Release(const int id)
 	{
 		m_mutex.Enter();
-		const int* const id = m_bitmaps.ReverseLookupPtr(bitmap);
-		if (id)
+		BitmapEntry* const entry = m_bitmaps.GetPtr(id);
+		if (entry)
 		{
-			m_bitmaps.Delete(*id);
-			delete bitmap;
+			assert(entry->refs > 0);
+			if (!--entry->refs) Evict();
+		}
+		m_mutex.Leave();
+	}
+
+	void SetBudget(const size_t bytes)
+	{
+		m_mutex.Enter();
+		m_budget = bytes;
+		Evict();
+		m_mutex.Leave();
+	}
+
+	// Mutex should be locked.
+	void Evict()
+	{
+		while (m_budget && m_bytes > m_budget)
+		{
+			int lruID = 0;
+			const BitmapEntry* lru = NULL;
+
+			const int n = m_bitmaps.GetSize();
+			for (int i = 0; i < n; ++i)
+			{
+				int id;
+				const BitmapEntry* const entry = m_bitmaps.EnumeratePtr(i, &id);
+				if (!entry->refs && (!lru || (int)(entry->lastUse - lru->lastUse) < 0))
+				{
+					lruID = id;
+					lru = entry;
+				}
+			}
+			if (!lru) break;
+
+			m_bytes -= lru->bytes;
+			m_bitmaps.Delete(lruID);
 		}
+	}
+
+	void GetStats(size_t* const pBytes, int* const pNumFull, int* const pNumHalf)
+	{
+		m_mutex.Enter();
+		int num[2] = { 0, 0 };
+
+		const int n = m_bitmaps.GetSize();
+		for (int i = 0; i < n; ++i)
+		{
+			int id = 0;
+			m_bitmaps.EnumeratePtr(i, &id);
+			num[id & 1]++;
+		}
+
+		if (pBytes) *pBytes = m_bytes;
+		if (pNumFull) *pNumFull = num[IGraphics::kScaleFull];
+		if (pNumHalf) *pNumHalf = num[IGraphics::kScaleHalf];
 		m_mutex.Leave();
-	} */
+	}
 
-	static void Dispose(LICE_IBitmap* const bitmap)
+	static void Dispose(const BitmapEntry entry)
 	{
-		delete bitmap;
+		delete entry.bitmap;
 	}
 
 	static const LICE_WrapperBitmap kEmptyBitmap;
@@ -64,15 +177,35 @@ public:
 	struct FontKey
 	{
 		WDL_UINT64 style;
-		const char* face;
+		const char* face; // Interned
 		LICE_IFont* font;
+		FontKey* next;
 	};
 
-	WDL_PtrList<FontKey> m_fonts;
+	// Fonts are never removed (until destruction), and number of buckets is
+	// fixed, so Find() can walk buckets without locking.
+	static const int kNumBuckets = 256;
+	std::atomic<FontKey*> m_buckets[kNumBuckets];
+
+	WDL_PtrList<char> m_faces;
 	WDL_Mutex m_mutex;
+	int m_numFonts;
+
+	std::atomic<unsigned int> m_hits, m_misses;
 
 	WDL_TypedBuf<int> m_load;
 
+	FontStorage(): m_numFonts(0)
+	{
+		for (int i = 0; i < kNumBuckets; ++i)
+		{
+			m_buckets[i].store(NULL, std::memory_order_relaxed);
+		}
+
+		m_hits.store(0, std::memory_order_relaxed);
+		m_misses.store(0, std::memory_order_relaxed);
+	}
+
 	static WDL_UINT64 PackStyle(const int size, const int style, const int orientation)
 	{
 		assert(style >= 0 && style < 8);
@@ -81,12 +214,25 @@ public:
 		return ((WDL_UINT64)((orientation << 3) | style) << 32) | size;
 	}
 
-	LICE_IFont* Find(const WDL_UINT64 style, const char* const face)
+	// FNV-1a
+	static unsigned int Hash(const WDL_UINT64 style, const char* const face)
 	{
-		const int n = m_fonts.GetSize();
-		for (int i = 0; i < n; ++i)
+		unsigned int hash = 2166136261u;
+		for (const unsigned char* p = (const unsigned char*)face; *p; ++p)
+		{
+			hash = (hash ^ *p) * 16777619u;
+		}
+
+		hash = (hash ^ (unsigned int)style) * 16777619u;
+		hash = (hash ^ (unsigned int)(style >> 32)) * 16777619u;
+
+		return hash;
+	}
+
+	LICE_IFont* Find(const WDL_UINT64 style, const char* const face, const unsigned int hash) const
+	{
+		for (const FontKey* key = m_buckets[hash % kNumBuckets].load(std::memory_order_acquire); key; key = key->next)
 		{
-			const FontKey* const key = m_fonts.Get(i);
 			if (key->style == style && (key->face == face || !strcmp(key->face, face)))
 			{
 				return key->font;
@@ -97,24 +243,52 @@ public:
 
 	LICE_IFont* Find(const IText* const pTxt, const int scale = 0)
 	{
-		m_mutex.Enter();
 		const WDL_UINT64 style = PackStyle(pTxt->mSize >> scale, pTxt->mStyle, pTxt->mOrientation);
-		LICE_IFont* const font = Find(style, pTxt->mFont);
-		m_mutex.Leave();
+		LICE_IFont* const font = Find(style, pTxt->mFont, Hash(style, pTxt->mFont));
+		(font ? m_hits : m_misses).fetch_add(1, std::memory_order_relaxed);
 		return font;
 	}
 
+	// Mutex should be locked.
+	const char* InternFace(const char* const face)
+	{
+		const int n = m_faces.GetSize();
+		for (int i = 0; i < n; ++i)
+		{
+			const char* const str = m_faces.Get(i);
+			if (!strcmp(str, face)) return str;
+		}
+
+		const size_t len = strlen(face) + 1;
+		char* const str = (char*)malloc(len);
+		if (!str) return NULL;
+
+		memcpy(str, face, len);
+		return m_faces.Add(str);
+	}
+
 	LICE_IFont* Add(LICE_IFont* const font, const IText* const pTxt, const int scale = 0)
 	{
 		m_mutex.Enter();
 		const WDL_UINT64 style = PackStyle(pTxt->mSize >> scale, pTxt->mStyle, pTxt->mOrientation);
-		LICE_IFont* ret = Find(style, pTxt->mFont);
+		const unsigned int hash = Hash(style, pTxt->mFont);
+		LICE_IFont* ret = Find(style, pTxt->mFont, hash);
 		if (!ret)
 		{
-			FontKey* const key = m_fonts.Add(new FontKey);
-			key->style = style;
-			key->face = pTxt->mFont;
-			key->font = ret = font;
+			const char* const face = InternFace(pTxt->mFont);
+			FontKey* const key = face ? new FontKey : NULL;
+			if (key)
+			{
+				std::atomic<FontKey*>* const pBucket = &m_buckets[hash % kNumBuckets];
+
+				key->style = style;
+				key->face = face;
+				key->font = ret = font;
+				key->next = pBucket->load(std::memory_order_relaxed);
+
+				pBucket->store(key, std::memory_order_release);
+				m_numFonts++;
+			}
 		}
 		m_mutex.Leave();
 		return ret;
@@ -122,12 +296,18 @@ public:
 
 	~FontStorage()
 	{
-		const int n = m_fonts.GetSize();
-		for (int i = 0; i < n; ++i)
+		for (int i = 0; i < kNumBuckets; ++i)
 		{
-			delete m_fonts.Get(i)->font;
+			FontKey* key = m_buckets[i].load(std::memory_order_relaxed);
+			while (key)
+			{
+				FontKey* const next = key->next;
+				delete key->font;
+				delete key;
+				key = next;
+			}
 		}
-		m_fonts.Empty(true);
+		m_faces.Empty(true, free);
 	}
 };
 
@@ -148,6 +328,11 @@ IGraphics::IGraphics(
 	mScale(-1),
 	mDefaultScale(kScaleFull),
 	mFPS(refreshFPS > 0 ? refreshFPS : kDefaultFPS),
+	mParamControlsNControls(-1),
+	mGridStamp(0),
+	mGridNControls(-1),
+	mGridW(0),
+	mGridH(0),
 	mMouseCapture(-1),
 	mMouseOver(-1),
 	mMouseX(0),
@@ -169,6 +354,13 @@ IGraphics::IGraphics(
 IGraphics::~IGraphics()
 {
 	mControls.Empty(true);
+
+	const int nBitmaps = mBitmapRefs.GetSize();
+	const int* const pIDs = mBitmapRefs.Get();
+	for (int i = 0; i < nBitmaps; ++i)
+	{
+		s_bitmapCache.Release(pIDs[i]);
+	}
 	// delete mTmpBitmap;
 }
 
@@ -235,33 +427,84 @@ void IGraphics::AttachBackground(const int ID, const char* const name)
 	mControls.Insert(0, pBG);
 }
 
-void IGraphics::HideControl(const int paramIdx, const bool hide)
+bool IGraphics::UpdateParamControls()
 {
-	const int n = mControls.GetSize();
+	// Controls are only ever added, so number of controls changes when
+	// control is attached.
+	const int nControls = mControls.GetSize();
+	if (nControls == mParamControlsNControls) return true;
+
+	const int nParams = mPlug->NParams();
+	int* const pOfs = mParamControlsOfs.ResizeOK(nParams + 2, false);
+	IControl** const ppParamControls = mParamControls.ResizeOK(nControls, false);
+
+	if (!pOfs || !ppParamControls)
+	{
+		mParamControlsNControls = -1;
+		return false;
+	}
+
 	IControl* const* const ppControl = mControls.GetList();
-	for (int i = 0; i < n; ++i)
+	memset(pOfs, 0, (nParams + 2) * sizeof(int));
+
+	// Count controls per param.
+	for (int i = 0; i < nControls; ++i)
+	{
+		const int paramIdx = ppControl[i]->ParamIdx();
+		if ((unsigned int)paramIdx < (unsigned int)nParams) pOfs[paramIdx + 2]++;
+	}
+
+	for (int i = 2; i < nParams + 2; ++i)
+	{
+		pOfs[i] += pOfs[i - 1];
+	}
+
+	// Now pOfs[paramIdx + 1] is start of param, and after adding controls
+	// it will be end of param (i.e. start of next param).
+	for (int i = 0; i < nControls; ++i)
 	{
 		IControl* const pControl = ppControl[i];
-		if (pControl->ParamIdx() == paramIdx)
-		{
-			pControl->Hide(hide);
-		}
-		// Could be more than one, don't break until we check them all.
+		const int paramIdx = pControl->ParamIdx();
+		if ((unsigned int)paramIdx < (unsigned int)nParams) ppParamControls[pOfs[paramIdx + 1]++] = pControl;
+	}
+
+	mParamControlsNControls = nControls;
+
+	return true;
+}
+
+IControl* const* IGraphics::GetParamControls(const int paramIdx, int* const pN)
+{
+	if (!UpdateParamControls() || !mPlug->NParams(paramIdx))
+	{
+		*pN = 0;
+		return NULL;
+	}
+
+	const int* const pOfs = mParamControlsOfs.Get();
+	const int ofs = pOfs[paramIdx];
+
+	*pN = pOfs[paramIdx + 1] - ofs;
+	return &mParamControls.Get()[ofs];
+}
+
+void IGraphics::HideControl(const int paramIdx, const bool hide)
+{
+	int n;
+	IControl* const* const ppControl = GetParamControls(paramIdx, &n);
+	for (int i = 0; i < n; ++i)
+	{
+		ppControl[i]->Hide(hide);
 	}
 }
 
 void IGraphics::GrayOutControl(const int paramIdx, const bool gray)
 {
-	const int n = mControls.GetSize();
-	IControl* const* const ppControl = mControls.GetList();
+	int n;
+	IControl* const* const ppControl = GetParamControls(paramIdx, &n);
 	for (int i = 0; i < n; ++i)
 	{
-		IControl* const pControl = ppControl[i];
-		if (pControl->ParamIdx() == paramIdx)
-		{
-			pControl->GrayOut(gray);
-		}
-		// Could be more than one, don't break until we check them all.
+		ppControl[i]->GrayOut(gray);
 	}
 }
 
@@ -273,17 +516,13 @@ void IGraphics::ClampControl(const int paramIdx, double lo, double hi, const boo
 		lo = pParam->GetNormalized(lo);
 		hi = pParam->GetNormalized(hi);
 	}
-	const int n = mControls.GetSize();
-	IControl* const* const ppControl = mControls.GetList();
+	int n;
+	IControl* const* const ppControl = GetParamControls(paramIdx, &n);
 	for (int i = 0; i < n; ++i)
 	{
 		IControl* const pControl = ppControl[i];
-		if (pControl->ParamIdx() == paramIdx)
-		{
-			pControl->Clamp(lo, hi);
-			pControl->SetDirty();
-		}
-		// Could be more than one, don't break until we check them all.
+		pControl->Clamp(lo, hi);
+		pControl->SetDirty();
 	}
 }
 
@@ -294,16 +533,11 @@ void IGraphics::SetParameterFromPlug(const int paramIdx, double value, const boo
 		const IParam* const pParam = mPlug->GetParam(paramIdx);
 		value = pParam->GetNormalized(value);
 	}
-	const int n = mControls.GetSize();
-	IControl* const* const ppControl = mControls.GetList();
+	int n;
+	IControl* const* const ppControl = GetParamControls(paramIdx, &n);
 	for (int i = 0; i < n; ++i)
 	{
-		IControl* const pControl = ppControl[i];
-		if (pControl->ParamIdx() == paramIdx)
-		{
-			pControl->SetValueFromPlug(value);
-			// Could be more than one, don't break until we check them all.
-		}
+		ppControl[i]->SetValueFromPlug(value);
 	}
 }
 
@@ -326,16 +560,11 @@ void IGraphics::SetAllControlsDirty()
 
 void IGraphics::SetParameterFromGUI(const int paramIdx, const double normalizedValue)
 {
-	const int n = mControls.GetSize();
-	IControl* const* const ppControl = mControls.GetList();
+	int n;
+	IControl* const* const ppControl = GetParamControls(paramIdx, &n);
 	for (int i = 0; i < n; ++i)
 	{
-		IControl* const pControl = ppControl[i];
-		if (pControl->ParamIdx() == paramIdx)
-		{
-			pControl->SetValueFromUserInput(normalizedValue);
-			// Could be more than one, don't break until we check them all.
-		}
+		ppControl[i]->SetValueFromUserInput(normalizedValue);
 	}
 }
 
@@ -349,8 +578,13 @@ void IGraphics::LoadBitmapResources(const BitmapResource* const pResources)
 
 IBitmap IGraphics::LoadIBitmap(const int ID, const char* const name, const int nStates)
 {
-	LICE_IBitmap* lb = s_bitmapCache.Find(ID);
-	if (!lb)
+	const bool addRef = mBitmapRefs.Find(ID) < 0;
+	LICE_IBitmap* lb = s_bitmapCache.Find(ID, addRef);
+	if (lb)
+	{
+		if (addRef) mBitmapRefs.Add(ID);
+	}
+	else
 	{
 		lb = OSLoadBitmap(ID, name);
 
@@ -364,7 +598,9 @@ IBitmap IGraphics::LoadIBitmap(const int ID, const char* const name, const int n
 		}
 		#endif
 
-		s_bitmapCache.Add(lb, ID);
+		// Not in cache, so we can't already have reference.
+		lb = s_bitmapCache.Add(lb, ID);
+		if (addRef) mBitmapRefs.Add(ID);
 	}
 	return IBitmap(lb, lb->getWidth(), lb->getHeight() / nStates, nStates);
 }
@@ -377,8 +613,16 @@ bool IGraphics::UpdateIBitmap(IBitmap* const pBitmap)
 	const int ID = pBitmap->ID() | Scale();
 	if (pBitmap->mID == ID && lb) return lb != empty;
 
-	lb = s_bitmapCache.Find(ID);
-	if (!lb) lb = empty;
+	const bool addRef = mBitmapRefs.Find(ID) < 0;
+	lb = s_bitmapCache.Find(ID, addRef);
+	if (lb)
+	{
+		if (addRef) mBitmapRefs.Add(ID);
+	}
+	else
+	{
+		lb = empty;
+	}
 
 	pBitmap->mData = lb;
 	pBitmap->W = lb->getWidth();
@@ -610,7 +854,7 @@ int IGraphics::DrawIText(IText* const pTxt, const char* const str, const IRECT*
 	static const UINT align[3] = { DT_LEFT, DT_CENTER, DT_RIGHT };
 	assert(pTxt->mAlign >= 0 && pTxt->mAlign < 3);
 
-	UINT fmt = align[pTxt->mAlign] | clip;
+	UINT fmt = align[(int)pTxt->mAlign] | clip;
 	if (LICE_GETA(color) < 255) fmt |= LICE_DT_USEFGALPHA;
 
 	RECT R = { pR->L, pR->T, pR->R, pR->B };
@@ -688,6 +932,29 @@ bool IGraphics::LoadFont(const int ID, const char* const name)
 	return ret;
 }
 
+void IGraphics::GetFontCacheStats(unsigned int* const pHits, unsigned int* const pMisses, int* const pNumFonts)
+{
+	if (pHits) *pHits = s_fontCache.m_hits.load(std::memory_order_relaxed);
+	if (pMisses) *pMisses = s_fontCache.m_misses.load(std::memory_order_relaxed);
+
+	if (pNumFonts)
+	{
+		s_fontCache.m_mutex.Enter();
+		*pNumFonts = s_fontCache.m_numFonts;
+		s_fontCache.m_mutex.Leave();
+	}
+}
+
+void IGraphics::SetBitmapCacheBudget(const size_t bytes)
+{
+	s_bitmapCache.SetBudget(bytes);
+}
+
+void IGraphics::GetBitmapCacheStats(size_t* const pBytes, int* const pNumFull, int* const pNumHalf)
+{
+	s_bitmapCache.GetStats(pBytes, pNumFull, pNumHalf);
+}
+
 LICE_CachedFont* IGraphics::CacheFont(IText* const pTxt, const int scale)
 {
 	LICE_CachedFont* font = (LICE_CachedFont*)s_fontCache.Find(pTxt, scale);
@@ -713,7 +980,7 @@ LICE_CachedFont* IGraphics::CacheFont(IText* const pTxt, const int scale)
 		};
 
 		assert(pTxt->mQuality >= 0 && pTxt->mQuality < 4);
-		const int q = quality[pTxt->mQuality];
+		const int q = quality[(int)pTxt->mQuality];
 
 		#ifdef __APPLE__
 		bool resized = false;
@@ -741,6 +1008,7 @@ LICE_CachedFont* IGraphics::CacheFont(IText* const pTxt, const int scale)
 		{
 			delete font;
 			font = cached;
+			if (!font) return NULL;
 		}
 	}
 	pTxt->mCached = font;
@@ -820,9 +1088,62 @@ void IGraphics::DrawRadialLine(const IColor color, const float cx, const float c
 	DrawLine(color, xLo, yLo, xHi, yHi, weight, antiAlias);
 }
 
-bool IGraphics::IsDirty(IRECT* const pR)
+static inline int RECTArea(const IRECT* const pR)
+{
+	return pR->W() * pR->H();
+}
+
+// Adds rect to dirty region, merging it with any overlapping rects, and
+// with nearby rects if this wouldn't add much area.
+static int AddDirtyRECT(IRECT* const pR, int n, const int maxN, IRECT r)
+{
+	for (int i = 0; i < n;)
+	{
+		const IRECT u = r.Union(&pR[i]);
+		if (r.Intersects(&pR[i]) || RECTArea(&u) <= RECTArea(&r) + RECTArea(&pR[i]))
+		{
+			// Remove merged rect, and start over, because union could now
+			// overlap rect we already checked.
+			pR[i] = pR[--n];
+			r = u;
+			i = 0;
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	if (n < maxN)
+	{
+		pR[n++] = r;
+		return n;
+	}
+
+	// Out of rects, so merge with rect that adds least area.
+	int best = 0, bestArea = 0;
+	for (int i = 0; i < n; ++i)
+	{
+		const IRECT u = r.Union(&pR[i]);
+		const int area = RECTArea(&u) - RECTArea(&pR[i]);
+		if (!i || area < bestArea)
+		{
+			best = i;
+			bestArea = area;
+		}
+	}
+
+	r = r.Union(&pR[best]);
+	pR[best] = pR[--n];
+	return AddDirtyRECT(pR, n, maxN, r);
+}
+
+int IGraphics::IsDirty(IRECT* const pR, const int maxRECTs)
 {
-	bool dirty = false;
+	assert(maxRECTs >= 1);
+	const int scale = Scale();
+
+	int nRECTs = 0;
 	const int n = mControls.GetSize();
 	IControl* const* const ppControl = mControls.GetList();
 	for (int i = 0; i < n; ++i)
@@ -831,30 +1152,31 @@ bool IGraphics::IsDirty(IRECT* const pR)
 		if (pControl->IsDirty())
 		{
 			pControl->SetClean();
-			*pR = pR->Union(pControl->GetRECT());
-			dirty = true;
-		}
-	}
+			IRECT r = *pControl->GetRECT();
+			if (r.Empty()) continue;
 
-	const int scale = Scale();
-	if (scale)
-	{
-		// const int mask = ~((1 << scale) - 1);
-		// pR->L &= mask;
-		// pR->T &= mask;
-		// pr->R = (((pr->R - 1) >> scale) + 1) << scale;
-		// pr->B = (((pr->B - 1) >> scale) + 1) << scale;
+			if (scale)
+			{
+				// const int mask = ~((1 << scale) - 1);
+				// r.L &= mask;
+				// r.T &= mask;
+				// r.R = (((r.R - 1) >> scale) + 1) << scale;
+				// r.B = (((r.B - 1) >> scale) + 1) << scale;
+
+				assert(scale == 1);
+				static const int mask = ~1;
+				r.L &= mask;
+				r.T &= mask;
+				r.R += r.R & 1;
+				r.B += r.B & 1;
+			}
 
-		assert(scale == 1);
-		static const int mask = ~1;
-		pR->L &= mask;
-		pR->T &= mask;
-		pR->R += pR->R & 1;
-		pR->B += pR->B & 1;
+			nRECTs = AddDirtyRECT(pR, nRECTs, maxRECTs, r);
+		}
 	}
 
 	#ifdef IPLUG_USE_IDLE_CALLS
-	if (dirty)
+	if (nRECTs)
 	{
 		mIdleTicks = 0;
 	}
@@ -865,28 +1187,50 @@ bool IGraphics::IsDirty(IRECT* const pR)
 	}
 	#endif
 
-	return dirty;
+	return nRECTs;
 }
 
 // The OS is announcing what needs to be redrawn,
 // which may be a larger area than what is strictly dirty.
-void IGraphics::Draw(const IRECT* const pR)
+void IGraphics::Draw(const IRECT* const pR, const int nRECTs)
 {
-	mDirtyRECT = pR;
+	// Only check controls in grid cells covered by dirty rects, or if
+	// grid isn't available then check all controls.
+	int n;
+	const int* const pIdx = GetGridControls(pR, nRECTs, &n);
+	if (!pIdx) n = mControls.GetSize();
 
-	const int n = mControls.GetSize();
 	IControl* const* const ppControl = mControls.GetList();
-	for (int i = 0; i < n; ++i)
+	IRECT unionR;
+	for (int k = 0; k < n; ++k)
 	{
-		IControl* const pControl = ppControl[i];
-		if (!pControl->IsHidden() && pR->Intersects(pControl->GetRECT()))
+		IControl* const pControl = ppControl[pIdx ? pIdx[k] : k];
+		if (pControl->IsHidden()) continue;
+
+		// A control could intersect more than one rect, in which case it is
+		// drawn only once against the union of those rects, so alpha blended
+		// controls aren't composited several times.
+		mDirtyRECT = NULL;
+		for (int j = 0; j < nRECTs; ++j)
 		{
-			pControl->Draw(this);
+			if (!pR[j].Intersects(pControl->GetRECT())) continue;
+
+			if (!mDirtyRECT)
+			{
+				mDirtyRECT = &pR[j];
+			}
+			else
+			{
+				unionR = mDirtyRECT->Union(&pR[j]);
+				mDirtyRECT = &unionR;
+			}
 		}
+
+		if (mDirtyRECT) pControl->Draw(this);
 	}
 
 	mDirtyRECT = NULL;
-	DrawScreen(pR);
+	DrawScreen(pR, nRECTs);
 }
 
 void IGraphics::OnMouseDown(const int x, const int y, const IMouseMod mod)
@@ -1048,6 +1392,27 @@ int IGraphics::GetMouseControlIdx(const int x, const int y)
 	// The BG is a control and will catch everything, so assume the programmer
 	// attached the controls from back to front, and return the frontmost match.
 	IControl* const* const ppControl = mControls.GetList();
+
+	// Only check controls in grid cell, unless outside of grid (e.g. mouse
+	// drag outside window).
+	if (x >= 0 && y >= 0 && x < Width() && y < Height() && UpdateControlGrid())
+	{
+		const int cell = (y / kGridCellSize) * mGridW + x / kGridCellSize;
+		const int* const pOfs = mGridOfs.Get();
+		const int* const pIdx = mGridControls.Get();
+
+		for (int j = pOfs[cell + 1] - 1; j >= pOfs[cell]; --j)
+		{
+			const int i = pIdx[j];
+			IControl* const pControl = ppControl[i];
+			if (!pControl->IsHidden() && !pControl->IsReadOnly() && pControl->IsHit(x, y))
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+
 	for (int i = mControls.GetSize() - 1; i >= 0; --i)
 	{
 		IControl* const pControl = ppControl[i];
@@ -1059,6 +1424,148 @@ int IGraphics::GetMouseControlIdx(const int x, const int y)
 	return -1;
 }
 
+// Gets range of grid cells covered by rect, returns false if outside grid.
+static bool GetGridCells(const IRECT* const pR, const int cellSize, const int gridW, const int gridH, int* const pX1, int* const pY1, int* const pX2, int* const pY2)
+{
+	if (pR->Empty() || pR->R <= 0 || pR->B <= 0) return false;
+
+	const int x1 = wdl_max(pR->L, 0) / cellSize;
+	const int y1 = wdl_max(pR->T, 0) / cellSize;
+	if (x1 >= gridW || y1 >= gridH) return false;
+
+	*pX1 = x1;
+	*pY1 = y1;
+	*pX2 = wdl_min((pR->R - 1) / cellSize, gridW - 1);
+	*pY2 = wdl_min((pR->B - 1) / cellSize, gridH - 1);
+
+	return true;
+}
+
+bool IGraphics::UpdateControlGrid()
+{
+	// Controls are only ever added, so number of controls changes when
+	// control is attached. Hidden controls stay in grid.
+	const int nControls = mControls.GetSize();
+	const int w = (Width() + kGridCellSize - 1) / kGridCellSize;
+	const int h = (Height() + kGridCellSize - 1) / kGridCellSize;
+	if (nControls == mGridNControls && w == mGridW && h == mGridH) return true;
+
+	mGridNControls = -1;
+
+	const int nCells = w * h;
+	int* const pOfs = mGridOfs.ResizeOK(nCells + 2, false);
+	unsigned int* const pStamps = mGridStamps.ResizeOK(nControls, false);
+	if (!pOfs || (!pStamps && nControls)) return false;
+
+	memset(pOfs, 0, (nCells + 2) * sizeof(int));
+	if (nControls) memset(pStamps, 0, nControls * sizeof(unsigned int));
+	mGridStamp = 0;
+
+	IControl* const* const ppControl = mControls.GetList();
+	int x1, y1, x2, y2;
+
+	// Count controls per cell.
+	for (int i = 0; i < nControls; ++i)
+	{
+		IControl* const pControl = ppControl[i];
+		const IRECT r = pControl->GetRECT()->Union(pControl->GetTargetRECT());
+		if (!GetGridCells(&r, kGridCellSize, w, h, &x1, &y1, &x2, &y2)) continue;
+
+		for (int y = y1; y <= y2; ++y)
+		{
+			for (int x = x1; x <= x2; ++x) pOfs[y * w + x + 2]++;
+		}
+	}
+
+	for (int i = 2; i < nCells + 2; ++i)
+	{
+		pOfs[i] += pOfs[i - 1];
+	}
+
+	const int total = pOfs[nCells + 1];
+	int* const pIdx = mGridControls.ResizeOK(total, false);
+	if (!pIdx && total) return false;
+
+	// Add controls in control order, so each cell is sorted back to front.
+	for (int i = 0; i < nControls; ++i)
+	{
+		IControl* const pControl = ppControl[i];
+		const IRECT r = pControl->GetRECT()->Union(pControl->GetTargetRECT());
+		if (!GetGridCells(&r, kGridCellSize, w, h, &x1, &y1, &x2, &y2)) continue;
+
+		for (int y = y1; y <= y2; ++y)
+		{
+			for (int x = x1; x <= x2; ++x) pIdx[pOfs[y * w + x + 1]++] = i;
+		}
+	}
+
+	mGridNControls = nControls;
+	mGridW = w;
+	mGridH = h;
+
+	return true;
+}
+
+static int CompareInt(const void* const pA, const void* const pB)
+{
+	const int a = *(const int*)pA, b = *(const int*)pB;
+	return (a > b) - (a < b);
+}
+
+// Returns (sorted) indices of controls in grid cells covered by rects, or
+// NULL if grid isn't available.
+const int* IGraphics::GetGridControls(const IRECT* const pR, const int nRECTs, int* const pN)
+{
+	if (!UpdateControlGrid()) return NULL;
+
+	const int nControls = mGridNControls;
+	int* const pCandidates = mGridCandidates.ResizeOK(nControls, false);
+	if (!pCandidates && nControls) return NULL;
+
+	// Use stamps to add each control only once.
+	unsigned int* const pStamps = mGridStamps.Get();
+	unsigned int stamp = ++mGridStamp;
+	if (!stamp)
+	{
+		memset(pStamps, 0, nControls * sizeof(unsigned int));
+		stamp = mGridStamp = 1;
+	}
+
+	const int* const pOfs = mGridOfs.Get();
+	const int* const pIdx = mGridControls.Get();
+	const int w = mGridW;
+
+	int n = 0;
+	for (int j = 0; j < nRECTs; ++j)
+	{
+		int x1, y1, x2, y2;
+		if (!GetGridCells(&pR[j], kGridCellSize, w, mGridH, &x1, &y1, &x2, &y2)) continue;
+
+		for (int y = y1; y <= y2; ++y)
+		{
+			for (int x = x1; x <= x2; ++x)
+			{
+				const int cell = y * w + x;
+				for (int k = pOfs[cell]; k < pOfs[cell + 1]; ++k)
+				{
+					const int i = pIdx[k];
+					if (pStamps[i] != stamp)
+					{
+						pStamps[i] = stamp;
+						pCandidates[n++] = i;
+					}
+				}
+			}
+		}
+	}
+
+	// Draw back to front.
+	if (n > 1) qsort(pCandidates, n, sizeof(int), CompareInt);
+
+	*pN = n;
+	return pCandidates;
+}
+
 void IGraphics::EndInformHostOfParamChange(const int controlIdx)
 {
 	const int paramIdx = mControls.Get(controlIdx)->ParamIdx();
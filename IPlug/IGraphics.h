@@ -34,15 +34,20 @@ public:
 	static const int kMaxParamLen = 32;
 	static const int kMaxEditLen = 1024;
 
+	// Max number of separate rects in dirty region.
+	static const int kMaxDirtyRECTs = 8;
+
 	enum EGUIScale { kScaleFull = 0, kScaleHalf = 1 };
 
 	bool PrepDraw(int wantScale); // Recale the draw bitmap.
-	bool IsDirty(IRECT* pR); // Ask the plugin what needs to be redrawn.
-	void Draw(const IRECT* pR); // The system announces what needs to be redrawn. Ordering and drawing logic.
-	virtual void DrawScreen(const IRECT* pR) = 0; // Tells the OS class to put the final bitmap on the screen.
+	int IsDirty(IRECT* pR, int maxRECTs = 1); // Ask the plugin what needs to be redrawn, returns number of (non-overlapping) rects.
+	void Draw(const IRECT* pR, int nRECTs = 1); // The system announces what needs to be redrawn. Ordering and drawing logic.
+	virtual void DrawScreen(const IRECT* pR, int nRECTs) = 0; // Tells the OS class to put the final bitmap on the screen.
 
 	// So controls can draw only area that will actually be drawn to screen.
-	// Guaranteed to be valid in IControl::Draw().
+	// Guaranteed to be valid in IControl::Draw(). If control intersects more
+	// than one dirty rect, then this is their union, and could also cover
+	// area that won't be drawn to screen.
 	inline const IRECT* GetDirtyRECT() const { return mDirtyRECT; }
 
 	// Methods for the drawing implementation class. Coordinates, offset,
@@ -69,6 +74,9 @@ public:
 	int DrawIText(IText* pTxt, const char* str, const IRECT* pR, int clip = DT_NOCLIP);
 	int MeasureIText(IText* pTxt, const char* str, IRECT* pR);
 
+	// Font cache lookup hits/misses, and number of cached fonts.
+	static void GetFontCacheStats(unsigned int* pHits, unsigned int* pMisses, int* pNumFonts = NULL);
+
 	IColor GetPoint(int x, int y);
 	// void* GetData() { return (void*)GetBits(); }
 
@@ -158,6 +166,12 @@ public:
 	IBitmap LoadIBitmap(int ID, const char* name, int nStates = 1);
 	bool UpdateIBitmap(IBitmap* pBitmap);
 
+	// Bitmaps no longer used by any IGraphics instance are evicted (least
+	// recently used first) when cache exceeds budget (0 = unlimited). Note
+	// that with budget you shouldn't keep IBitmaps around after GUI closes.
+	static void SetBitmapCacheBudget(size_t bytes);
+	static void GetBitmapCacheStats(size_t* pBytes, int* pNumFull = NULL, int* pNumHalf = NULL);
+
 	void AttachBackground(int ID, const char* name);
 	void AttachBackground(IControl* const pControl) { mControls.Insert(0, pControl); }
 
@@ -176,6 +190,15 @@ public:
 	}
 	#endif
 
+	// Rebuilds param to controls map when next needed. Call after changing
+	// control's param index (IControl::SetParamIdx() already does).
+	inline void InvalidateParamControls() { mParamControlsNControls = -1; }
+
+	// Rebuilds hit-test/draw grid when next needed. Call after moving
+	// control (IControl::SetRECT() and SetTargetArea() already do).
+	// Hidden controls stay in grid, so no need to call after hiding.
+	inline void InvalidateControlGrid() { mGridNControls = -1; }
+
 	// Returns control index, or -1 if not found.
 	int FindControl(const IControl* const pControl) const
 	{
@@ -195,6 +218,10 @@ public:
 	int NControls() const { return mControls.GetSize(); }
 	bool NControls(const int idx) const { return (unsigned int)idx < (unsigned int)NControls(); }
 
+	// Returns controls associated with param (in control order), and sets
+	// number of controls in *pN.
+	IControl* const* GetParamControls(int paramIdx, int* pN);
+
 	void HideControl(int paramIdx, bool hide);
 	void GrayOutControl(int paramIdx, bool gray);
 
@@ -339,12 +366,36 @@ protected:
 private:
 	// LICE_MemBitmap* mTmpBitmap;
 
+	// IDs of cached bitmaps this instance holds reference to.
+	WDL_TypedBuf<int> mBitmapRefs;
+
 	const IRECT* mDirtyRECT;
 	int mWidth, mHeight, mScale, mDefaultScale, mFPS;
 
 	int GetMouseControlIdx(int x, int y);
 	void EndInformHostOfParamChange(int controlIdx);
 
+	// Controls grouped by param index, controls of param i are at
+	// mParamControls[mParamControlsOfs[i]..mParamControlsOfs[i + 1] - 1].
+	WDL_TypedBuf<int> mParamControlsOfs;
+	WDL_TypedBuf<IControl*> mParamControls;
+	int mParamControlsNControls;
+
+	bool UpdateParamControls();
+
+	// Uniform grid over control rects (union of draw and mouse target
+	// area), used for hit-testing and draw culling. Control indices of
+	// cell i are at mGridControls[mGridOfs[i]..mGridOfs[i + 1] - 1].
+	static const int kGridCellSize = 64;
+
+	WDL_TypedBuf<int> mGridOfs, mGridControls, mGridCandidates;
+	WDL_TypedBuf<unsigned int> mGridStamps;
+	unsigned int mGridStamp;
+	int mGridNControls, mGridW, mGridH;
+
+	bool UpdateControlGrid();
+	const int* GetGridControls(const IRECT* pR, int nRECTs, int* pN);
+
 	int mMouseCapture, mMouseOver, mMouseX, mMouseY;
 	int mKeyboardFocus;
 	bool mHandleMouseOver, mEnableTooltips;
@@ -132,8 +132,24 @@ static IMouseMod GetRightMouseMod(const NSEvent* const pEvent, const bool right,
 {
 	if (mGraphics)
 	{
-		const IRECT r = ToIRECT(mGraphics, &rect);
-		mGraphics->Draw(&r);
+		const NSRect* pRects;
+		NSInteger n;
+		[self getRectsBeingDrawn: &pRects count: &n];
+
+		IRECT r[IGraphics::kMaxDirtyRECTs];
+		if (n > 0 && n <= IGraphics::kMaxDirtyRECTs)
+		{
+			for (NSInteger i = 0; i < n; ++i)
+			{
+				r[i] = ToIRECT(mGraphics, &pRects[i]);
+			}
+		}
+		else
+		{
+			r[0] = ToIRECT(mGraphics, &rect);
+			n = 1;
+		}
+		mGraphics->Draw(r, (int)n);
 	}
 }
 
@@ -163,10 +179,11 @@ static IMouseMod GetRightMouseMod(const NSEvent* const pEvent, const bool right,
 			mGraphics->GetPlug()->OnGUITimer();
 		}
 
-		IRECT r;
-		if (mGraphics->IsDirty(&r))
+		IRECT r[IGraphics::kMaxDirtyRECTs];
+		const int n = mGraphics->IsDirty(r, IGraphics::kMaxDirtyRECTs);
+		for (int i = 0; i < n; ++i)
 		{
-			[self setNeedsDisplayInRect: ToNSRect(mGraphics, &r)];
+			[self setNeedsDisplayInRect: ToNSRect(mGraphics, &r[i])];
 		}
 
 		int timer = mParamChangeTimer;
@@ -0,0 +1,214 @@
+#include "IGraphicsHeadless.h"
+
+#include <dlfcn.h>
+#include <pwd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "WDL/lice/lice.h"
+#include "WDL/wdlcstring.h"
+
+// Any symbol in plugin binary will do for dladdr().
+static const char sPluginPathAnchor = 0;
+
+IGraphicsHeadless::IGraphicsHeadless(
+	IPlugBase* const pPlug,
+	const int w,
+	const int h,
+	const int refreshFPS
+):
+	IGraphics(pPlug, w, h, refreshFPS),
+	mFrameCount(0),
+	mParamChangeTimer(0),
+	mWindowOpen(false)
+{}
+
+IGraphicsHeadless::~IGraphicsHeadless()
+{
+	CloseWindow();
+}
+
+bool IGraphicsHeadless::FindResourceFile(WDL_String* const pPath, const char* const name, const char* const ext)
+{
+	if (!name) return false;
+
+	if (mResourcePath.GetLength())
+	{
+		pPath->Set(mResourcePath.Get());
+		const int len = pPath->GetLength();
+		if (pPath->Get()[len - 1] != WDL_DIRCHAR) pPath->Append(WDL_DIRCHAR_STR);
+	}
+	else if (!PluginPath(pPath))
+	{
+		return false;
+	}
+
+	// Same as on macOS, strip path and extension from name.
+	const char* const file = WDL_get_filepart(name);
+	const char* const dot = strrchr(file, '.');
+	pPath->Append(file, dot > file ? (int)(dot - file) : 0);
+
+	pPath->Append(".");
+	pPath->Append(ext);
+
+	return access(pPath->Get(), R_OK) == 0;
+}
+
+LICE_IBitmap* IGraphicsHeadless::OSLoadBitmap(int /* ID */, const char* const name)
+{
+	WDL_String path;
+	return FindResourceFile(&path, name, "png") ? LICE_LoadPNG(path.Get()) : NULL;
+}
+
+bool IGraphicsHeadless::OSLoadFont(int /* ID */, const char* const name)
+{
+	WDL_String path;
+	return FindResourceFile(&path, name, "ttf") && !!AddFontResourceEx(path.Get(), FR_PRIVATE, NULL);
+}
+
+void IGraphicsHeadless::GetInitialSize(int* const pWidth, int* const pHeight)
+{
+	const int scale = ForceDPI() == kForceScaleHalf ? kScaleHalf : kScaleFull;
+
+	*pWidth = Width() >> scale;
+	*pHeight = Height() >> scale;
+}
+
+void IGraphicsHeadless::DrawScreen(const IRECT* /* pR */, int /* nRECTs */)
+{
+	const int frame = mFrameCount++;
+
+	if (mDumpPrefix.GetLength())
+	{
+		WDL_String fn;
+		fn.SetFormatted(mDumpPrefix.GetLength() + 16, "%s%06d.png", mDumpPrefix.Get(), frame);
+		LICE_WritePNG(fn.Get(), &mBackBuf, false);
+	}
+}
+
+bool IGraphicsHeadless::RenderFrame()
+{
+	if (!mWindowOpen) return false;
+
+	GetPlug()->InformHostOfParamReset();
+
+	if (TimerEnabled())
+	{
+		GetPlug()->OnGUITimer();
+	}
+
+	IRECT r[kMaxDirtyRECTs];
+	const int n = IsDirty(r, kMaxDirtyRECTs);
+	if (n) Draw(r, n);
+
+	const int timer = mParamChangeTimer;
+	if (timer && !(mParamChangeTimer = timer - 1))
+	{
+		GetPlug()->EndDelayedInformHostOfParamChange();
+	}
+
+	return !!n;
+}
+
+void* IGraphicsHeadless::OpenWindow(void* /* pParentWnd */)
+{
+	const int scale = ForceDPI() == kForceScaleHalf ? kScaleHalf : kScaleFull;
+	if (!PrepDraw(scale)) return NULL;
+
+	mWindowOpen = true;
+	SetAllControlsDirty();
+
+	return GetWindow();
+}
+
+void IGraphicsHeadless::CloseWindow()
+{
+	if (mWindowOpen)
+	{
+		GetPlug()->EndDelayedInformHostOfParamChange();
+		mParamChangeTimer = 0;
+		mWindowOpen = false;
+	}
+}
+
+bool IGraphicsHeadless::HostPath(WDL_String* const pPath)
+{
+	char buf[4096];
+	const ssize_t len = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+	if (len > 0)
+	{
+		buf[len] = 0;
+		pPath->Set(buf);
+		return true;
+	}
+	pPath->Set("");
+	return false;
+}
+
+bool IGraphicsHeadless::PluginPath(WDL_String* const pPath)
+{
+	Dl_info info;
+	if (dladdr((const void*)&sPluginPathAnchor, &info) && info.dli_fname)
+	{
+		// Includes trailing slash.
+		const char* const fn = info.dli_fname;
+		pPath->Set(fn, (int)(WDL_get_filepart(fn) - fn));
+		return true;
+	}
+	pPath->Set("");
+	return false;
+}
+
+bool IGraphicsHeadless::UserDataPath(WDL_String* const pPath)
+{
+	const char* const config = getenv("XDG_CONFIG_HOME");
+	if (config && *config)
+	{
+		pPath->Set(config);
+		return true;
+	}
+
+	const char* home = getenv("HOME");
+	if (!home || !*home)
+	{
+		struct passwd* const pw = getpwuid(getuid());
+		home = pw ? pw->pw_dir : NULL;
+	}
+
+	if (home)
+	{
+		pPath->Set(home);
+		pPath->Append(WDL_DIRCHAR_STR ".config");
+		return true;
+	}
+	pPath->Set("");
+	return false;
+}
+
+#ifndef NDEBUG
+void IPlugDebugLog(const char* const str)
+{
+	fputs(str, stderr);
+	fputc('\n', stderr);
+}
+#endif
+
+bool IGraphicsHeadless::PromptForFile(WDL_String* const pFilename, int /* action */, const char* /* dir */, const char* /* extensions */)
+{
+	pFilename->Set("");
+	return false;
+}
+
+bool IGraphicsHeadless::PromptUserInput(IControl* /* pControl */, IParam* /* pParam */, const IRECT* /* pR */,
+	int /* flags */, IText* /* pTxt */, IColor /* bg */, int /* delay */, int /* x */, int /* y */)
+{
+	return false;
+}
+
+bool IGraphicsHeadless::OpenURL(const char* /* url */, const char* /* windowTitle */,
+	const char* /* confirmMsg */, const char* /* errMsg */)
+{
+	return false;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+// Offscreen IGraphics for Linux (or any OS with SWELL/LICE), which renders
+// into the backbuffer without ever showing a window. Useful for automated
+// tests, benchmarks, and CI. Drive it by calling RenderFrame() instead of
+// waiting for an OS timer. See CMakeLists.txt for Linux build.
+
+#include "IControl.h"
+#include "IGraphics.h"
+
+#include "WDL/wdlstring.h"
+
+#define IPLUG_RESOURCE(xxx) (xxx##_ID), (xxx##_FN)
+#define IPLUG_PNG_RESOURCE(id, name) (id), (name)
+
+class IGraphicsHeadless: public IGraphics
+{
+public:
+	IGraphicsHeadless(IPlugBase* pPlug, int w, int h, int refreshFPS = 0);
+	~IGraphicsHeadless();
+
+	// Directory to load PNG/TTF resources from (default is plugin dir).
+	void SetResourcePath(const char* const path) { mResourcePath.Set(path); }
+
+	// If set, then DrawScreen() writes backbuffer to "<prefix>NNNNNN.png",
+	// where NNNNNN is frame number.
+	void SetDumpPrefix(const char* const prefix) { mDumpPrefix.Set(prefix); }
+
+	void DrawScreen(const IRECT* pR, int nRECTs);
+
+	// Does what OS timer would do, i.e. calls OnGUITimer() (if enabled),
+	// and draws dirty controls. Returns true if anything was drawn.
+	bool RenderFrame();
+
+	// Number of DrawScreen() calls.
+	inline int FrameCount() const { return mFrameCount; }
+
+	// The parent window is ignored, but returns non-NULL on success.
+	void* OpenWindow(void* pParentWnd);
+	void CloseWindow();
+	void* GetWindow() const { return mWindowOpen ? (void*)this : NULL; }
+
+	void UpdateTooltips() {}
+
+	bool HostPath(WDL_String* pPath);
+	bool PluginPath(WDL_String* pPath);
+	bool UserDataPath(WDL_String* pPath);
+
+	bool PromptForFile(WDL_String* pFilename, int action = kFileOpen, const char* dir = NULL, const char* extensions = NULL);
+	bool PromptUserInput(IControl* pControl, IParam* pParam, const IRECT* pR = NULL, int flags = 0, IText* pTxt = NULL, IColor bg = IColor(0), int delay = 0, int x = 0, int y = 0);
+
+	bool OpenURL(const char* url, const char* windowTitle = NULL, const char* confirmMsg = NULL, const char* errMsg = NULL);
+
+	void SetParamChangeTimer(const int ticks) { mParamChangeTimer = ticks; }
+	void CancelParamChangeTimer() { mParamChangeTimer = 0; }
+
+	// Returns initial GUI size based on Width(), Height(), and ForceDPI().
+	void GetInitialSize(int* pWidth, int* pHeight);
+
+protected:
+	LICE_IBitmap* OSLoadBitmap(int ID, const char* name);
+	bool OSLoadFont(int ID, const char* name);
+
+	bool FindResourceFile(WDL_String* pPath, const char* name, const char* ext);
+
+private:
+	WDL_FastString mResourcePath, mDumpPrefix;
+	int mFrameCount, mParamChangeTimer;
+	bool mWindowOpen;
+};
@@ -20,7 +20,7 @@ public:
 
 	void SetBundleID(const char* const bundleID) { mBundleID.Set(bundleID); }
 
-	void DrawScreen(const IRECT* pR);
+	void DrawScreen(const IRECT* pR, int nRECTs);
 
 	bool InitScale();
 	bool UpdateScale();
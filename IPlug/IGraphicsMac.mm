@@ -105,7 +105,7 @@ void IGraphicsMac::GetInitialSize(int* const pWidth, int* const pHeight)
 	*pHeight = h >> scale;
 }
 
-void IGraphicsMac::DrawScreen(const IRECT* /* pR */)
+void IGraphicsMac::DrawScreen(const IRECT* /* pR */, int /* nRECTs */)
 {
 	int w = Width(), h = Height();
 	const int dpi = ForceDPI();
@@ -57,6 +57,31 @@ static IMouseMod GetKeyMod(const bool bWheel = false)
 	return IMouseMod(false, false, GetKeyState(VK_SHIFT) < 0, GetKeyState(VK_CONTROL) < 0, GetKeyState(VK_MENU) < 0, bWheel);
 }
 
+// Gets update region as separate rects, or as bounding rect if region
+// consists of too many rects.
+static int GetUpdateRECTs(HWND const hWnd, RECT* const pR, const int maxRECTs)
+{
+	if (!GetUpdateRect(hWnd, pR, FALSE)) return 0;
+
+	int n = 1;
+	HRGN const rgn = CreateRectRgn(0, 0, 0, 0);
+	if (rgn && GetUpdateRgn(hWnd, rgn, FALSE) == COMPLEXREGION)
+	{
+		char buf[sizeof(RGNDATAHEADER) + IGraphics::kMaxDirtyRECTs * sizeof(RECT)];
+		const DWORD size = (DWORD)(sizeof(RGNDATAHEADER) + wdl_min(maxRECTs, IGraphics::kMaxDirtyRECTs) * sizeof(RECT));
+
+		RGNDATA* const pData = (RGNDATA*)buf;
+		if (GetRegionData(rgn, size, pData) == size && pData->rdh.iType == RDH_RECTANGLES)
+		{
+			n = pData->rdh.nCount;
+			memcpy(pR, pData->Buffer, n * sizeof(RECT));
+		}
+	}
+	if (rgn) DeleteObject(rgn);
+
+	return n;
+}
+
 static void DeleteParamEditFont(HWND const hWnd)
 {
 	HFONT const font = (HFONT)SendMessageW(hWnd, WM_GETFONT, 0, 0);
@@ -99,8 +124,9 @@ LRESULT CALLBACK IGraphicsWin::WndProc(HWND const hWnd, const UINT msg, const WP
 					pGraphics->GetPlug()->OnGUITimer();
 				}
 
-				IRECT dirtyR;
-				if (pGraphics->IsDirty(&dirtyR))
+				IRECT dirtyR[kMaxDirtyRECTs];
+				const int nDirty = pGraphics->IsDirty(dirtyR, kMaxDirtyRECTs);
+				if (nDirty)
 				{
 					RECT cR, r;
 					GetClientRect(hWnd, &cR);
@@ -112,31 +138,35 @@ LRESULT CALLBACK IGraphicsWin::WndProc(HWND const hWnd, const UINT msg, const WP
 					const int wDiv = pGraphics->Width();
 					const int hDiv = pGraphics->Height();
 
-					if ((wDiv >> scale) == wMul && (hDiv >> scale) == hMul)
+					for (int i = 0; i < nDirty; ++i)
 					{
-						r.left = dirtyR.L >> scale;
-						r.top = dirtyR.T >> scale;
-						r.right = dirtyR.R >> scale;
-						r.bottom = dirtyR.B >> scale;
-					}
-					else
-					{
-						const int x = MulDiv(dirtyR.L, wMul, wDiv);
-						const int y = MulDiv(dirtyR.T, hMul, hDiv);
-						const int w = MulDiv(dirtyR.R - dirtyR.L, wMul, wDiv);
-						const int h = MulDiv(dirtyR.B - dirtyR.T, hMul, hDiv);
-
-						r.left = x - 1;
-						r.top = y - 1;
-						r.right = x + w + 1;
-						r.bottom = y + h + 1;
-
-						r.left = wdl_max(r.left, cR.left);
-						r.top = wdl_max(r.top, cR.top);
-						r.right = wdl_min(r.right, cR.right);
-						r.bottom = wdl_min(r.bottom, cR.bottom);
+						const IRECT* const pR = &dirtyR[i];
+						if ((wDiv >> scale) == wMul && (hDiv >> scale) == hMul)
+						{
+							r.left = pR->L >> scale;
+							r.top = pR->T >> scale;
+							r.right = pR->R >> scale;
+							r.bottom = pR->B >> scale;
+						}
+						else
+						{
+							const int x = MulDiv(pR->L, wMul, wDiv);
+							const int y = MulDiv(pR->T, hMul, hDiv);
+							const int w = MulDiv(pR->R - pR->L, wMul, wDiv);
+							const int h = MulDiv(pR->B - pR->T, hMul, hDiv);
+
+							r.left = x - 1;
+							r.top = y - 1;
+							r.right = x + w + 1;
+							r.bottom = y + h + 1;
+
+							r.left = wdl_max(r.left, cR.left);
+							r.top = wdl_max(r.top, cR.top);
+							r.right = wdl_min(r.right, cR.right);
+							r.bottom = wdl_min(r.bottom, cR.bottom);
+						}
+						InvalidateRect(hWnd, &r, FALSE);
 					}
-					InvalidateRect(hWnd, &r, FALSE);
 
 					if (pGraphics->mParamEditWnd)
 					{
@@ -325,10 +355,11 @@ LRESULT CALLBACK IGraphicsWin::WndProc(HWND const hWnd, const UINT msg, const WP
 
 		case WM_PAINT:
 		{
-			RECT r;
-			if (GetUpdateRect(hWnd, &r, FALSE))
+			RECT updateR[kMaxDirtyRECTs];
+			const int n = GetUpdateRECTs(hWnd, updateR, kMaxDirtyRECTs);
+			if (n)
 			{
-				IRECT ir(r.left, r.top, r.right, r.bottom);
+				RECT r;
 				GetClientRect(hWnd, &r);
 
 				const int wMul = pGraphics->Width();
@@ -336,20 +367,27 @@ LRESULT CALLBACK IGraphicsWin::WndProc(HWND const hWnd, const UINT msg, const WP
 				const int wDiv = r.right - r.left;
 				const int hDiv = r.bottom - r.top;
 
-				if (wMul != wDiv || hMul != hDiv)
+				IRECT ir[kMaxDirtyRECTs];
+				for (int i = 0; i < n; ++i)
 				{
-					const int x = MulDiv(ir.L, wMul, wDiv);
-					const int y = MulDiv(ir.T, hMul, hDiv);
-					const int w = MulDiv(ir.R - ir.L, wMul, wDiv);
-					const int h = MulDiv(ir.B - ir.T, hMul, hDiv);
-
-					ir.L = x;
-					ir.T = y;
-					ir.R = x + w;
-					ir.B = y + h;
+					const RECT* const pR = &updateR[i];
+					ir[i] = IRECT(pR->left, pR->top, pR->right, pR->bottom);
+
+					if (wMul != wDiv || hMul != hDiv)
+					{
+						const int x = MulDiv(ir[i].L, wMul, wDiv);
+						const int y = MulDiv(ir[i].T, hMul, hDiv);
+						const int w = MulDiv(ir[i].R - ir[i].L, wMul, wDiv);
+						const int h = MulDiv(ir[i].B - ir[i].T, hMul, hDiv);
+
+						ir[i].L = x;
+						ir[i].T = y;
+						ir[i].R = x + w;
+						ir[i].B = y + h;
+					}
 				}
 
-				pGraphics->Draw(&ir);
+				pGraphics->Draw(ir, n);
 			}
 			return 0;
 		}
@@ -587,7 +625,7 @@ void IGraphicsWin::GetInitialSize(int* const pWidth, int* const pHeight)
 	*pHeight = h;
 }
 
-void IGraphicsWin::DrawScreen(const IRECT* const pR)
+void IGraphicsWin::DrawScreen(const IRECT* const pR, const int nRECTs)
 {
 	HWND const hWnd = (HWND)GetWindow();
 
@@ -607,12 +645,15 @@ void IGraphicsWin::DrawScreen(const IRECT* const pR)
 
 	if (wDest == wSrc && hDest == hSrc)
 	{
-		const int x = pR->L >> scale;
-		const int cx = pR->W() >> scale;
-		const int y = pR->T >> scale;
-		const int cy = pR->H() >> scale;
+		for (int i = 0; i < nRECTs; ++i)
+		{
+			const int x = pR[i].L >> scale;
+			const int cx = pR[i].W() >> scale;
+			const int y = pR[i].T >> scale;
+			const int cy = pR[i].H() >> scale;
 
-		BitBlt(dc, x, y, cx, cy, dcSrc, x, y, SRCCOPY);
+			BitBlt(dc, x, y, cx, cy, dcSrc, x, y, SRCCOPY);
+		}
 	}
 	else
 	{
@@ -17,7 +17,7 @@ public:
 	inline void SetHInstance(HINSTANCE const hInstance) { mHInstance = hInstance; }
 
 	// void Resize(int w, int h);
-	void DrawScreen(const IRECT* pR);
+	void DrawScreen(const IRECT* pR, int nRECTs);
 
 	void* OpenWindow(void* pParentWnd);
 	void CloseWindow();
@@ -71,8 +71,15 @@
 	{
 		IPlug::SetBlockSize(blockSize);
 		mMidiQueue.Resize(GetBlockSize(), false);
+
+		// Or, to never allocate on the audio thread, reserve room for e.g.
+		// 2 messages per sample:
+		// mMidiQueue.ResizeFixed(GetBlockSize(), 2.0, IMidiQueue::kOverflowCoalesce);
 	}
 
+	For polyphonic instruments IVoiceEngine (see IVoiceEngine.h) implements
+	the above loop, and handles voice allocation.
+
 */
 
 #pragma once
@@ -86,15 +93,29 @@
 class IMidiQueue
 {
 public:
+	// What to do if the queue is full in fixed size mode (see
+	// ResizeFixed()), or if it can't expand itself.
+	enum EOverflowPolicy
+	{
+		kOverflowDropNewest = 0,
+		kOverflowDropOldest, // Drops oldest message that isn't a note off.
+		kOverflowCoalesce    // Replaces queued CC/pitch wheel/aftertouch with same CC/channel, or else drops newest.
+	};
+
 	IMidiQueue(const int size = IPlugBase::kDefaultBlockSize)
 	{
-		mFront = mBack = 0;
+		mFront = mBack = mEpoch = 0;
+		#ifdef MERGE_SORT_IMIDIQUEUE
+		mSorted = 0;
+		#endif
 		mGrow = size;
+		mPolicy = kOverflowDropNewest;
+		ResetStats();
 		Expand();
 	}
 
 	// Adds a MIDI message at the back of the queue. If the queue is full,
-	// it will automatically expand itself.
+	// it will automatically expand itself, unless in fixed size mode.
 	void Add(const IMidiMsg* const pMsg)
 	{
 		if (mBack >= GetSize())
@@ -102,14 +123,18 @@ public:
 			if (mFront > 0)
 				Compact();
 			else
-				if (!Expand()) return;
+				if (!Expand() && !Overflow(pMsg)) return;
 		}
 
 		IMidiMsg* const buf = mBuf.GetFast();
+		const int ofs = pMsg->mOffset + mEpoch;
 
-		#ifndef DONT_SORT_IMIDIQUEUE
+		#if defined(MERGE_SORT_IMIDIQUEUE)
+		// Append, and sort later (see Sort()). Messages in order only
+		// extend sorted part.
+		if (mSorted == mBack && (mBack == mFront || ofs >= buf[mBack - 1].mOffset)) ++mSorted;
+		#elif !defined(DONT_SORT_IMIDIQUEUE)
 		unsigned int i = mFront, j = mBack;
-		const int ofs = pMsg->mOffset;
 
 		// Insert the MIDI message at the right offset.
 		if (mBack > mFront && ofs < buf[--j].mOffset)
@@ -130,14 +155,18 @@ public:
 			}
 			memmove(&buf[i + 1], &buf[i], (mBack - i) * sizeof(IMidiMsg));
 			buf[i] = *pMsg;
+			buf[i].mOffset = ofs;
 		}
 		else
 		#endif
 		{
-			buf[(unsigned int)mBack] = *pMsg;
+			IMidiMsg* const pBack = &buf[(unsigned int)mBack];
+			*pBack = *pMsg;
+			pBack->mOffset = ofs;
 		}
 
 		++mBack;
+		mHighWater = wdl_max(mHighWater, mBack - mFront);
 	}
 
 	// Removes a MIDI message from the front of the queue (but does *not*
@@ -155,42 +184,92 @@ public:
 	inline int GetSize() const { return mBuf.GetSize(); }
 
 	// Returns the "next" MIDI message (all the way in the front of the
-	// queue), but does *not* remove it from the queue.
+	// queue), but does *not* remove it from the queue. The returned pointer
+	// is only valid until the next call.
+	#ifdef MERGE_SORT_IMIDIQUEUE
+	inline const IMidiMsg* Peek()
+	{
+		if (mSorted < mBack) Sort();
+	#else
 	inline const IMidiMsg* Peek() const
 	{
-		return &mBuf.GetFast()[(unsigned int)mFront];
+	#endif
+		mPeek = mBuf.GetFast()[(unsigned int)mFront];
+		mPeek.mOffset -= mEpoch;
+		return &mPeek;
 	}
 
-	// Moves back MIDI messages all the way to the front of the queue, thus
-	// freeing up space at the back, and updates the sample offset of the
-	// remaining MIDI messages by substracting nFrames.
+	// Updates the sample offset of the remaining MIDI messages by
+	// substracting nFrames. Queued messages store offsets relative to an
+	// epoch, so this just advances the epoch. Space at the front is freed
+	// up once it reaches half the queue (or when the queue is empty or
+	// full).
 	void Flush(int const nFrames)
 	{
-		// Move everything all the way to the front.
-		if (mFront > 0) Compact();
+		if (mFront >= mBack)
+		{
+			Clear();
+			return;
+		}
 
-		// Update the sample offset.
-		IMidiMsg* const buf = mBuf.GetFast();
-		const unsigned int j = mBack;
-		for (unsigned int i = 0; i < j; ++i) buf[i].mOffset -= nFrames;
+		if (mFront >= GetSize() >> 1) Compact();
+		mEpoch += nFrames;
+
+		// Rebase before epoch overflows (after ~6 hours at 48 kHz).
+		if (mEpoch >= kMaxEpoch)
+		{
+			IMidiMsg* const buf = mBuf.GetFast();
+			for (int i = mFront; i < mBack; ++i) buf[i].mOffset -= mEpoch;
+			mEpoch = 0;
+		}
 	}
 
 	// Clears the queue.
-	inline void Clear() { mFront = mBack = 0; }
+	inline void Clear()
+	{
+		mFront = mBack = mEpoch = 0;
+		#ifdef MERGE_SORT_IMIDIQUEUE
+		mSorted = 0;
+		#endif
+	}
 
-	// Resizes (grows or shrinks) the queue, returns the new size.
+	// Resizes (grows or shrinks) the queue, returns the new size. Queue
+	// will automatically expand itself.
 	int Resize(int size, const bool resizeDown = true)
 	{
 		if (mFront > 0) Compact();
 		mGrow = size;
+		mPolicy = kOverflowDropNewest;
 
 		// Don't shrink below the number of currently queued MIDI messages.
 		size = wdl_max(size, mBack);
 
 		mBuf.Resize(size, resizeDown);
+		#ifdef MERGE_SORT_IMIDIQUEUE
+		mScratch.Resize(mBuf.GetSize(), resizeDown);
+		#endif
 		return mBuf.GetSize();
 	}
 
+	// Fixed size mode: Reserves room for blockSize * eventsPerFrame
+	// messages, after which Add() never allocates, but handles overflow as
+	// per policy. Call from SetBlockSize(), returns the new size.
+	int ResizeFixed(const int blockSize, const double eventsPerFrame = 1.0, const int policy = kOverflowDropNewest)
+	{
+		const int size = Resize(wdl_max((int)(blockSize * eventsPerFrame + 0.5), 1));
+
+		mGrow = 0;
+		mPolicy = policy;
+		return size;
+	}
+
+	// Overflow statistics, read from audio thread (or when not processing).
+	inline int GetHighWater() const { return mHighWater; } // Max queued messages.
+	inline int GetNumDropped() const { return mNDropped; }
+	inline int GetNumCoalesced() const { return mNCoalesced; }
+
+	inline void ResetStats() { mHighWater = mNDropped = mNCoalesced = 0; }
+
 protected:
 	// Automatically expands the queue.
 	bool Expand()
@@ -199,9 +278,154 @@ protected:
 		const int size = (GetSize() / mGrow + 1) * mGrow;
 
 		mBuf.Resize(size);
+		#ifdef MERGE_SORT_IMIDIQUEUE
+		mScratch.Resize(mBuf.GetSize());
+		#endif
 		return mBuf.GetSize() == size;
 	}
 
+	// Makes room for message as per overflow policy, returns false if
+	// message should be dropped.
+	bool Overflow(const IMidiMsg* const pMsg)
+	{
+		const IMidiMsg* const buf = mBuf.GetFast();
+		int i = -1;
+
+		switch (mPolicy)
+		{
+			case kOverflowDropOldest:
+			{
+				#ifdef MERGE_SORT_IMIDIQUEUE
+				if (mSorted < mBack) Sort();
+				#endif
+
+				for (int j = mFront; j < mBack; ++j)
+				{
+					if (!IsNoteOff(&buf[j]))
+					{
+						i = j;
+						break;
+					}
+				}
+				break;
+			}
+
+			case kOverflowCoalesce:
+			{
+				if (!CanCoalesce(pMsg)) break;
+
+				// Compare status, and CC/note number (if any).
+				const int nBytes = pMsg->mStatus >= 0xD0 ? 1 : 2;
+				for (int j = mBack - 1; j >= mFront; --j)
+				{
+					if (!memcmp(&buf[j].mStatus, &pMsg->mStatus, nBytes))
+					{
+						i = j;
+						++mNCoalesced;
+						break;
+					}
+				}
+				break;
+			}
+		}
+
+		if (i < 0)
+		{
+			++mNDropped;
+			return false;
+		}
+
+		if (mPolicy == kOverflowDropOldest) ++mNDropped;
+		RemoveAt(i);
+		return true;
+	}
+
+	static bool IsNoteOff(const IMidiMsg* const pMsg)
+	{
+		const int status = pMsg->mStatus >> 4;
+		return status == IMidiMsg::kNoteOff || (status == IMidiMsg::kNoteOn && !pMsg->mData2);
+	}
+
+	// Continuous controllers, pitch wheel, and aftertouch. Switches, bank
+	// select, data entry, (N)RPN etc. are never coalesced.
+	static bool CanCoalesce(const IMidiMsg* const pMsg)
+	{
+		switch (pMsg->mStatus >> 4)
+		{
+			case IMidiMsg::kPolyAftertouch:
+			case IMidiMsg::kChannelAftertouch:
+			case IMidiMsg::kPitchWheel:
+			{
+				return true;
+			}
+
+			case IMidiMsg::kControlChange:
+			{
+				const int cc = pMsg->mData1 & 0x1F;
+				return (pMsg->mData1 < 64 && cc != IMidiMsg::kBankSelect && cc != IMidiMsg::kDataEntry) ||
+					(pMsg->mData1 >= IMidiMsg::kSoundVariation && pMsg->mData1 <= IMidiMsg::kPhaserDepth);
+			}
+		}
+
+		return false;
+	}
+
+	void RemoveAt(const int i)
+	{
+		IMidiMsg* const buf = mBuf.GetFast();
+		memmove(&buf[i], &buf[i + 1], (mBack - i - 1) * sizeof(IMidiMsg));
+		--mBack;
+
+		#ifdef MERGE_SORT_IMIDIQUEUE
+		if (i < mSorted) --mSorted;
+		#endif
+	}
+
+	#ifdef MERGE_SORT_IMIDIQUEUE
+	// Sorts messages appended out of order: Stable merge sort of unsorted
+	// part into scratch buffer, then merges it with sorted part, so a burst
+	// of n out of order messages costs O(n log n) instead of O(n^2).
+	void Sort()
+	{
+		IMidiMsg* const buf = mBuf.GetFast();
+		IMidiMsg* const scratch = mScratch.GetFast();
+
+		const int start = wdl_max(mSorted, mFront);
+		const int n = mBack - start;
+
+		IMidiMsg* pSrc = &buf[start];
+		IMidiMsg* pDest = scratch;
+
+		for (int width = 1; width < n; width <<= 1)
+		{
+			for (int lo = 0; lo < n; lo += width << 1)
+			{
+				const int mid = wdl_min(lo + width, n), hi = wdl_min(lo + (width << 1), n);
+				int i = lo, j = mid, k = lo;
+
+				while (i < mid && j < hi) pDest[k++] = pSrc[j].mOffset < pSrc[i].mOffset ? pSrc[j++] : pSrc[i++];
+				while (i < mid) pDest[k++] = pSrc[i++];
+				while (j < hi) pDest[k++] = pSrc[j++];
+			}
+
+			IMidiMsg* const pTmp = pSrc;
+			pSrc = pDest;
+			pDest = pTmp;
+		}
+
+		if (pSrc != scratch) memcpy(scratch, pSrc, n * sizeof(IMidiMsg));
+
+		// Merge from the back, sorted part goes first if same offset.
+		int i = start - 1, j = n - 1, k = mBack - 1;
+		while (j >= 0)
+		{
+			buf[k--] = i >= mFront && buf[i].mOffset > scratch[j].mOffset ? buf[i--] : scratch[j--];
+		}
+
+		mSorted = mBack;
+	}
+	#endif
+
 	// Moves everything all the way to the front.
 	void Compact()
 	{
@@ -211,9 +435,21 @@ protected:
 			IMidiMsg* const buf = mBuf.GetFast();
 			memmove(&buf[0], &buf[i], n * sizeof(IMidiMsg));
 		}
+		#ifdef MERGE_SORT_IMIDIQUEUE
+		mSorted = wdl_max(mSorted - (int)i, 0);
+		#endif
 		mFront = 0;
 	}
 
+	static const int kMaxEpoch = 1 << 30;
+
 	WDL_TypedBuf<IMidiMsg> mBuf;
-	int mFront, mBack, mGrow;
+	int mFront, mBack, mEpoch, mGrow, mPolicy;
+	mutable IMidiMsg mPeek;
+
+	#ifdef MERGE_SORT_IMIDIQUEUE
+	WDL_TypedBuf<IMidiMsg> mScratch;
+	int mSorted; // Messages up to here are sorted.
+	#endif
+	int mHighWater, mNDropped, mNCoalesced;
 };
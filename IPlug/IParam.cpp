@@ -46,7 +46,7 @@ IBoolParam::IBoolParam(
 ):
 	IParam(kTypeBool, name)
 {
-	mBoolVal = defaultVal;
+	Set(defaultVal);
 
 	mDisplayTexts[0].Set(off ? off : "Off");
 	mDisplayTexts[1].Set(on ? on : "On");
@@ -59,7 +59,7 @@ void IBoolParam::SetDisplayText(const bool boolVal, const char* const text)
 
 void IBoolParam::SetNormalized(const double normalizedValue)
 {
-	mBoolVal = normalizedValue >= 0.5;
+	Set(normalizedValue >= 0.5);
 }
 
 double IBoolParam::GetNormalized(const double nonNormalizedValue) const
@@ -114,7 +114,9 @@ bool IBoolParam::Serialize(ByteChunk* const pChunk) const
 
 int IBoolParam::Unserialize(const ByteChunk* const pChunk, const int startPos)
 {
-	return pChunk->GetBool(&mBoolVal, startPos);
+	const int endPos = pChunk->GetBool(&mBoolVal, startPos);
+	SetAtomicValue((double)mBoolVal);
+	return endPos;
 }
 
 IEnumParam::IEnumParam(
@@ -128,6 +130,7 @@ IEnumParam::IEnumParam(
 {
 	assert(nEnums >= 2);
 	assert(defaultVal >= 0 && defaultVal < nEnums);
+	SetAtomicValue((double)defaultVal);
 
 	for (int i = 0; i < nEnums; ++i)
 	{
@@ -144,6 +147,7 @@ void IEnumParam::SetDisplayText(const int intVal, const char* const text)
 void IEnumParam::SetNormalized(const double normalizedValue)
 {
 	mIntVal = FromNormalized(normalizedValue);
+	SetAtomicValue((double)mIntVal);
 }
 
 double IEnumParam::GetNormalized() const
@@ -209,7 +213,9 @@ bool IEnumParam::Serialize(ByteChunk* const pChunk) const
 
 int IEnumParam::Unserialize(const ByteChunk* const pChunk, const int startPos)
 {
-	return pChunk->GetInt32(&mIntVal, startPos);
+	const int endPos = pChunk->GetInt32(&mIntVal, startPos);
+	SetAtomicValue((double)mIntVal);
+	return endPos;
 }
 
 IIntParam::IIntParam(
@@ -230,6 +236,8 @@ IIntParam::IIntParam(
 	assert(minVal != maxVal);
 	AssertInt(defaultVal);
 	#endif
+
+	SetAtomicValue((double)defaultVal);
 }
 
 void IIntParam::SetDisplayText(const int intVal, const char* const text)
@@ -247,6 +255,7 @@ void IIntParam::SetDisplayText(const int intVal, const char* const text)
 void IIntParam::SetNormalized(const double normalizedValue)
 {
 	mIntVal = FromNormalized(normalizedValue);
+	SetAtomicValue((double)mIntVal);
 }
 
 double IIntParam::GetNormalized() const
@@ -345,7 +354,9 @@ bool IIntParam::Serialize(ByteChunk* const pChunk) const
 
 int IIntParam::Unserialize(const ByteChunk* const pChunk, const int startPos)
 {
-	return pChunk->GetInt32(&mIntVal, startPos);
+	const int endPos = pChunk->GetInt32(&mIntVal, startPos);
+	SetAtomicValue((double)mIntVal);
+	return endPos;
 }
 
 #ifndef NDEBUG
@@ -380,6 +391,7 @@ IDoubleParam::IDoubleParam(
 	#endif
 
 	mDisplayPrecision = displayPrecision;
+	SetAtomicValue(defaultVal);
 }
 
 void IDoubleParam::SetDisplayText(const double normalizedValue, const char* const text)
@@ -400,6 +412,7 @@ double IDoubleParam::DBToAmp() const
 void IDoubleParam::SetNormalized(const double normalizedValue)
 {
 	mValue = FromNormalized(normalizedValue);
+	SetAtomicValue(mValue);
 }
 
 double IDoubleParam::GetNormalized() const
@@ -479,7 +492,7 @@ int IDoubleParam::ToIntKey(const double normalizedValue)
 double IDoubleParam::FromIntKey(const int key)
 {
 	WDL_UINT64 i = ((WDL_UINT64)(unsigned int)key << 20) | WDL_UINT64_CONST(0x3FF0000000000000);
-	i = key == 0xFFFFFFFF ? WDL_UINT64_CONST(0x4000000000000000) : i;
+	i = (unsigned int)key == 0xFFFFFFFF ? WDL_UINT64_CONST(0x4000000000000000) : i;
 
 	double x;
 	memcpy(&x, &i, sizeof(double));
@@ -523,7 +536,9 @@ bool IDoubleParam::Serialize(ByteChunk* const pChunk) const
 
 int IDoubleParam::Unserialize(const ByteChunk* const pChunk, const int startPos)
 {
-	return pChunk->GetDouble(&mValue, startPos);
+	const int endPos = pChunk->GetDouble(&mValue, startPos);
+	SetAtomicValue(mValue);
+	return endPos;
 }
 
 #ifndef NDEBUG
@@ -560,6 +575,7 @@ void IDoublePowParam::SetShape(const double nonNormalizedValue, const double nor
 void IDoublePowParam::SetNormalized(const double normalizedValue)
 {
 	mValue = FromNormalized(normalizedValue);
+	SetAtomicValue(mValue);
 }
 
 double IDoublePowParam::GetNormalized() const
@@ -606,6 +622,7 @@ void IDoubleExpParam::SetShape(const double nonNormalizedValue, const double nor
 void IDoubleExpParam::SetNormalized(const double normalizedValue)
 {
 	mValue = FromNormalized(normalizedValue);
+	SetAtomicValue(mValue);
 }
 
 double IDoubleExpParam::GetNormalized() const
@@ -637,6 +654,7 @@ INormalizedParam::INormalizedParam(
 	mValue(defaultVal)
 {
 	assert(defaultVal >= 0.0 && defaultVal <= 1.0);
+	SetAtomicValue(defaultVal);
 }
 
 void INormalizedParam::SetNormalized(const double normalizedValue)
@@ -659,7 +677,7 @@ char* INormalizedParam::ToString(const double normalizedValue, char* const buf,
 {
 	assert(normalizedValue >= 0.0 && normalizedValue <= 1.0);
 
-	char tmp[12];
+	char tmp[16];
 	snprintf(tmp, sizeof(tmp), "%.6g", normalizedValue);
 
 	if (tmp[0] && !tmp[1])
@@ -690,5 +708,7 @@ bool INormalizedParam::Serialize(ByteChunk* const pChunk) const
 
 int INormalizedParam::Unserialize(const ByteChunk* const pChunk, const int startPos)
 {
-	return pChunk->GetDouble(&mValue, startPos);
+	const int endPos = pChunk->GetDouble(&mValue, startPos);
+	SetAtomicValue(mValue);
+	return endPos;
 }
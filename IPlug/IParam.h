@@ -23,7 +23,8 @@ public:
 		mNegateDisplay(0),
 		mGlobalParam(0),
 		_unused(0),
-		mName(name)
+		mName(name),
+		mAtomicValue(0.0)
 	{
 		mShortName[0] = 0;
 	}
@@ -44,6 +45,13 @@ public:
 	virtual double GetNormalized(double nonNormalizedValue) const = 0;
 	virtual double GetNonNormalized(double normalizedValue) const = 0;
 
+	// Copy of value that can be read from any thread without locking
+	// mutex. Set(), SetNormalized(), and Unserialize() update it.
+	inline double GetAtomicValue() const { return mAtomicValue.load(std::memory_order_relaxed); }
+	inline double GetAtomicNormalized() const { return GetNormalized(GetAtomicValue()); }
+	// Makes value available before it is applied (e.g. queued GUI change).
+	inline void SetAtomicNormalized(const double normalizedValue) { SetAtomicValue(GetNonNormalized(normalizedValue)); }
+
 	virtual char* GetDisplayForHost(char* buf, int bufSize = 128) = 0;
 	virtual char* GetDisplayForHost(double normalizedValue, char* buf, int bufSize = 128) = 0;
 	const char* GetNameForHost() const { return mName.Get(); }
@@ -96,6 +104,11 @@ protected:
 
 	static void Delete(WDL_FastString* const str) { delete str; }
 
+	inline void SetAtomicValue(const double nonNormalizedValue)
+	{
+		mAtomicValue.store(nonNormalizedValue, std::memory_order_relaxed);
+	}
+
 	char mType, mDisplayPrecision;
 	bool mBoolVal;
 
@@ -103,6 +116,8 @@ protected:
 
 	WDL_FastString mName;
 	char mShortName[8];
+
+	std::atomic<double> mAtomicValue; // Non-normalized.
 };
 
 class IBoolParam: public IParam
@@ -115,7 +130,12 @@ public:
 		const char* on = NULL
 	);
 
-	inline void Set(const bool boolVal) { mBoolVal = boolVal; }
+	inline void Set(const bool boolVal)
+	{
+		mBoolVal = boolVal;
+		SetAtomicValue((double)boolVal);
+	}
+
 	void SetDisplayText(bool boolVal, const char* text);
 
 	inline bool Bool() const { return mBoolVal; }
@@ -170,6 +190,7 @@ public:
 	{
 		assert(intVal >= 0 && intVal < mEnums);
 		mIntVal = intVal;
+		SetAtomicValue((double)intVal);
 	}
 
 	void SetDisplayText(int intVal, const char* text);
@@ -243,6 +264,7 @@ public:
 		#endif
 
 		mIntVal = intVal;
+		SetAtomicValue((double)intVal);
 	}
 
 	void SetDisplayText(int intVal, const char* text);
@@ -331,6 +353,7 @@ public:
 		#endif
 
 		mValue = nonNormalizedValue;
+		SetAtomicValue(nonNormalizedValue);
 	}
 
 	void SetDisplayText(double normalizedValue, const char* text);
@@ -553,6 +576,7 @@ public:
 	{
 		assert(normalizedValue >= 0.0 && normalizedValue <= 1.0);
 		mValue = normalizedValue;
+		SetAtomicValue(normalizedValue);
 	}
 
 	inline double Value() const { return mValue; }
@@ -1,5 +1,6 @@
 #include "IPlugAAX.h"
 #include "IGraphics.h"
+#include "IChunkCodec.h"
 
 #ifdef __APPLE__
 	#include "IGraphicsMac.h"
@@ -695,6 +696,9 @@ void AAX_CALLBACK IPlugAAX::AAXAlgProcessFunc(void* const instBegin[], const voi
 			memcpy(pPlug->mTimeSig, timeSig, 2 * sizeof(int32_t));
 		}
 
+		// Include MIDI handling in process stats.
+		pPlug->BeginProcessStats();
+
 		if (pPlug->DoesMIDI(kPlugDoesMidiIn))
 		{
 			AAX_IMIDINode* const pMidiInNode = instance->mMidiInNode;
@@ -720,6 +724,8 @@ void AAX_CALLBACK IPlugAAX::AAXAlgProcessFunc(void* const instBegin[], const voi
 
 void IPlugAAX::ProcessMidiInNode(const AAX_CMidiPacket* const pBuf, const uint32_t nPackets)
 {
+	CountProcessEvents(nPackets);
+
 	bool sysExMode = mSysExMode;
 
 	for (uint32_t i = 0; i < nPackets; ++i)
@@ -825,7 +831,11 @@ AAX_Result IPlugAAX::AAXGetChunkSize(const AAX_CTypeID id, uint32_t* const pSize
 		if (mState.AllocSize() || AllocStateChunk())
 		{
 			mState.Clear();
-			if (SerializeState(&mState))
+			if (SerializeState(&mState)
+				#ifdef IPLUG_COMPRESS_STATE
+				&& IChunkCodec::CompressInPlace(&mState)
+				#endif
+			)
 			{
 				size = mState.Size();
 				err = AAX_SUCCESS;
@@ -851,7 +861,11 @@ AAX_Result IPlugAAX::AAXGetChunk(const AAX_CTypeID id, AAX_SPlugInChunk* const p
 	mMutex.Enter();
 
 	mState.Clear();
-	if (SerializeState(&mState))
+	if (SerializeState(&mState)
+		#ifdef IPLUG_COMPRESS_STATE
+		&& IChunkCodec::CompressInPlace(&mState)
+		#endif
+	)
 	{
 		const void* const pData = mState.GetBytes();
 		const int size = mState.Size();
@@ -881,11 +895,7 @@ AAX_Result IPlugAAX::AAXSetChunk(const AAX_CTypeID id, const AAX_SPlugInChunk* c
 	mMutex.Enter();
 
 	const int size = pChunk->fSize;
-	if (mState.Size() != size)
-	{
-		mState.Resize(size);
-		if (mState.Size() != size) err = AAX_ERROR_INCORRECT_CHUNK_SIZE;
-	}
+	if (size < 0) err = AAX_ERROR_INCORRECT_CHUNK_SIZE;
 
 	if (err == AAX_SUCCESS)
 	{
@@ -894,8 +904,11 @@ AAX_Result IPlugAAX::AAXSetChunk(const AAX_CTypeID id, const AAX_SPlugInChunk* c
 
 		RestorePreset(name);
 
-		memcpy(mState.GetBytes(), pChunk->fData, size);
-		const int pos = UnserializeState(&mState, 0);
+		// Read directly from host memory (unless compressed).
+		const ByteChunkView chunk(pChunk->fData, size);
+		ByteChunk temp;
+		DrainGUIParamQueue();
+		const int pos = UnserializeState(IChunkCodec::DecompressIfCompressed(&chunk, &temp), 0);
 
 		OnParamReset();
 
@@ -1,6 +1,7 @@
 #include "IPlugAU.h"
 #include "IGraphicsMac.h"
 #include "Hosts.h"
+#include "IChunkCodec.h"
 
 #include "dfx/dfx-au-utilities.h"
 
@@ -636,6 +637,7 @@ ComponentResult IPlugAU::IPlugAUEntry(ComponentParameters* const params, void* c
 			msg.mStatus = status;
 			msg.mData1 = data1;
 			msg.mData2 = data2;
+			_this->CountProcessEvents(1);
 			_this->ProcessMidiMsg(&msg);
 			break;
 		}
@@ -650,6 +652,7 @@ ComponentResult IPlugAU::IPlugAUEntry(ComponentParameters* const params, void* c
 			const UInt8* const pData = GET_COMP_PARAM(UInt8*, 1, 2);
 			const UInt32 size = GET_COMP_PARAM(UInt32, 0, 2);
 			const ISysEx sysex(0, pData, size);
+			_this->CountProcessEvents(1);
 			_this->ProcessSysEx(&sysex);
 			break;
 		}
@@ -1093,7 +1096,14 @@ ComponentResult IPlugAU::GetProperty(const AudioUnitPropertyID propID, const Aud
 
 		case kAudioUnitProperty_TailTime:                       // 20, listenable
 		{
-			return GetProperty(kAudioUnitProperty_Latency, scope, element, pDataSize, pWriteable, pData);
+			ASSERT_SCOPE(kAudioUnitScope_Global);
+			*pDataSize = sizeof(Float64);
+			if (pData)
+			{
+				const int tail = wdl_max(GetTailSize(), 0);
+				*(Float64*)pData = (double)(GetLatency() + tail) / GetSampleRate();
+			}
+			return noErr;
 		}
 
 		case kAudioUnitProperty_BypassEffect:                   // 21,
@@ -1707,19 +1717,18 @@ static bool GetStrFromDict(CFDictionaryRef const pDict, const char* const key, c
 	return false;
 }
 
-static bool GetDataFromDict(CFDictionaryRef const pDict, const char* const key, ByteChunk* const pChunk)
+// Returns view of data owned by dictionary, so don't release dictionary
+// while still using view.
+static bool GetDataFromDict(CFDictionaryRef const pDict, const char* const key, ByteChunkView* const pChunk)
 {
 	const CFStrLocal cfKey(key);
 	CFDataRef const pData = (CFDataRef)CFDictionaryGetValue(pDict, cfKey.mCFStr);
 	if (pData)
 	{
 		const CFIndex n = CFDataGetLength(pData);
-		if (pChunk->Size() != n)
-		{
-			pChunk->Resize((int)n);
-			if (pChunk->Size() != n) return false;
-		}
-		memcpy(pChunk->GetBytes(), CFDataGetBytePtr(pData), n);
+		if ((int)n != n) return false;
+
+		pChunk->Set(CFDataGetBytePtr(pData), (int)n);
 		return true;
 	}
 	return false;
@@ -1746,6 +1755,10 @@ ComponentResult IPlugAU::GetState(CFDictionaryRef* const ppDict)
 	if (SerializeState(&mState))
 	#endif
 	{
+		#ifdef IPLUG_COMPRESS_STATE
+		IChunkCodec::CompressInPlace(&mState);
+		#endif
+
 		PutDataInDict(pDict, kAUPresetDataKey, &mState);
 	}
 
@@ -1771,16 +1784,21 @@ ComponentResult IPlugAU::SetState(CFDictionaryRef const pDict)
 	}
 	RestorePreset(presetName);
 
-	if (!GetDataFromDict(pDict, kAUPresetDataKey, &mState))
+	ByteChunkView chunk;
+	if (!GetDataFromDict(pDict, kAUPresetDataKey, &chunk))
 	{
 		return kAudioUnitErr_InvalidPropertyValue;
 	}
 
+	ByteChunk temp;
+	const ByteChunk* const pChunk = IChunkCodec::DecompressIfCompressed(&chunk, &temp);
+
+	DrainGUIParamQueue();
 	const int pos =
 	#ifdef IPLUG_NO_STATE_CHUNKS
-	UnserializeParams(0, NParams(), &mState, 0);
+	UnserializeParams(0, NParams(), pChunk, 0);
 	#else
-	UnserializeState(&mState, 0);
+	UnserializeState(pChunk, 0);
 	#endif
 
 	OnParamReset();
@@ -1835,35 +1853,12 @@ ComponentResult IPlugAU::GetParamProc(void* const pPlug, const AudioUnitParamete
 {
 	ASSERT_SCOPE(kAudioUnitScope_Global);
 	IPlugAU* const _this = (IPlugAU*)pPlug;
-	_this->mMutex.Enter();
 
+	// Wait-free, so don't lock mutex, but use atomic value.
 	const IParam* const pParam = _this->GetParam(paramID);
-	AudioUnitParameterValue v;
+	const double v = pParam->Type() != IParam::kTypeNone ? pParam->GetAtomicValue() : pParam->GetAtomicNormalized();
+	*pValue = (AudioUnitParameterValue)v;
 
-	switch (pParam->Type())
-	{
-		case IParam::kTypeBool:
-			v = (AudioUnitParameterValue)((IBoolParam*)pParam)->Bool();
-			break;
-		case IParam::kTypeInt:
-			v = (AudioUnitParameterValue)((IIntParam*)pParam)->Int();
-			break;
-		case IParam::kTypeEnum:
-			v = (AudioUnitParameterValue)((IEnumParam*)pParam)->Int();
-			break;
-		case IParam::kTypeDouble:
-			v = (AudioUnitParameterValue)((IDoubleParam*)pParam)->Value();
-			break;
-		case IParam::kTypeNormalized:
-			v = (AudioUnitParameterValue)((INormalizedParam*)pParam)->Value();
-			break;
-		default:
-			v = (AudioUnitParameterValue)pParam->GetNormalized();
-			break;
-	}
-	*pValue = v;
-
-	_this->mMutex.Leave();
 	return noErr;
 }
 
@@ -1896,7 +1891,7 @@ static ComponentResult RenderCallback(const AURenderCallbackStruct* const pCB, A
 }
 
 // static
-ComponentResult IPlugAU::RenderProc(void* const pPlug, AudioUnitRenderActionFlags* /* pFlags */, const AudioTimeStamp* const pTimestamp,
+ComponentResult IPlugAU::RenderProc(void* const pPlug, AudioUnitRenderActionFlags* const pFlags, const AudioTimeStamp* const pTimestamp,
 	const UInt32 outputBusIdx, const UInt32 nFrames, AudioBufferList* const pOutBufList)
 {
 	IPlugAU* const _this = (IPlugAU*)pPlug;
@@ -2008,6 +2003,7 @@ ComponentResult IPlugAU::RenderProc(void* const pPlug, AudioUnitRenderActionFlag
 	else
 	{
 		_this->ProcessBuffers((AudioSampleType)0, nFrames);
+		if (_this->IsOutputSilent()) *pFlags |= kAudioUnitRenderAction_OutputIsSilence;
 	}
 
 	for (int i = 0; i < nRenderNotify; ++i)
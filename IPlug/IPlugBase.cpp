@@ -1,6 +1,7 @@
 #include "IPlugBase.h"
 #include "IGraphics.h"
 #include "Hosts.h"
+#include "ICastCopy.h"
 
 #include <stdarg.h>
 #include <string.h>
@@ -25,6 +26,98 @@ void IPlugBase::CastCopyAccumulating(DEST* const pDest, const SRC* const pSrc, c
 	}
 }
 
+#ifdef IPLUG_SIMD_AVX
+static const bool sHasAVX = CPUHasAVX();
+#endif
+
+// Specializations for the float <-> double conversions done for each
+// audio block. These use AVX if the CPU supports it, else SSE2 or NEON,
+// and finish remaining samples in plain C++ (see ICastCopy.h).
+
+template <>
+void IPlugBase::CastCopy(double* const pDest, const float* const pSrc, const int n)
+{
+	int i = 0;
+
+	#ifdef IPLUG_SIMD_AVX
+	if (sHasAVX) i = CastFloatToDoubleAVX(pDest, pSrc, n);
+	#endif
+
+	#if defined(IPLUG_SIMD_SSE2)
+	i += CastFloatToDoubleSSE2(&pDest[i], &pSrc[i], n - i);
+	#elif defined(IPLUG_SIMD_NEON)
+	i += CastFloatToDoubleNEON(&pDest[i], &pSrc[i], n - i);
+	#endif
+
+	for (; i < n; ++i)
+	{
+		pDest[i] = (double)pSrc[i];
+	}
+}
+
+template <>
+void IPlugBase::CastCopy(float* const pDest, const double* const pSrc, const int n)
+{
+	int i = 0;
+
+	#ifdef IPLUG_SIMD_AVX
+	if (sHasAVX) i = CastDoubleToFloatAVX(pDest, pSrc, n);
+	#endif
+
+	#if defined(IPLUG_SIMD_SSE2)
+	i += CastDoubleToFloatSSE2(&pDest[i], &pSrc[i], n - i);
+	#elif defined(IPLUG_SIMD_NEON)
+	i += CastDoubleToFloatNEON(&pDest[i], &pSrc[i], n - i);
+	#endif
+
+	for (; i < n; ++i)
+	{
+		pDest[i] = (float)pSrc[i];
+	}
+}
+
+template <>
+void IPlugBase::CastCopyAccumulating(float* const pDest, const double* const pSrc, const int n)
+{
+	int i = 0;
+
+	#ifdef IPLUG_SIMD_AVX
+	if (sHasAVX) i = CastDoubleToFloatAccumulatingAVX(pDest, pSrc, n);
+	#endif
+
+	#if defined(IPLUG_SIMD_SSE2)
+	i += CastDoubleToFloatAccumulatingSSE2(&pDest[i], &pSrc[i], n - i);
+	#elif defined(IPLUG_SIMD_NEON)
+	i += CastDoubleToFloatAccumulatingNEON(&pDest[i], &pSrc[i], n - i);
+	#endif
+
+	for (; i < n; ++i)
+	{
+		pDest[i] += (float)pSrc[i];
+	}
+}
+
+template <>
+void IPlugBase::CastCopyAccumulating(float* const pDest, const float* const pSrc, const int n)
+{
+	int i = 0;
+
+	#ifdef IPLUG_SIMD_AVX
+	if (sHasAVX) i = CastFloatToFloatAccumulatingAVX(pDest, pSrc, n);
+	#endif
+
+	#if defined(IPLUG_SIMD_SSE2)
+	i += CastFloatToFloatAccumulatingSSE2(&pDest[i], &pSrc[i], n - i);
+	#elif defined(IPLUG_SIMD_NEON)
+	i += CastFloatToFloatAccumulatingNEON(&pDest[i], &pSrc[i], n - i);
+	#endif
+
+	for (; i < n; ++i)
+	{
+		pDest[i] += pSrc[i];
+	}
+}
+
 static void GetVersionParts(unsigned int version, int* const pParts)
 {
 	const int ver = version >> 16;
@@ -67,6 +160,8 @@ IPlugBase::IPlugBase(
 ):
 	mCurrentPresetIdx(0),
 	mParamChangeIdx(-1),
+	mpPrevParamValues(NULL),
+	mGUIQueueEnabled(false),
 	mEffectName(effectName),
 	mProductName(productName),
 	mMfrName(mfrName),
@@ -82,7 +177,7 @@ IPlugBase::IPlugBase(
 	mGraphics(NULL),
 	mPresetChunkSize(-1)
 {
-	assert(plugDoes == (plugDoes & (kPlugIsInst | kPlugDoesMidi)));
+	assert(plugDoes == (plugDoes & (kPlugIsInst | kPlugDoesMidi | kPlugDoesSingleReplacing)));
 
 	for (int i = 0; i < nPresets; ++i)
 	{
@@ -106,11 +201,31 @@ IPlugBase::IPlugBase(
 		if (channelIOStr) ++channelIOStr;
 	}
 
+	mGUIParamQueue.Resize(kGUIParamQueueSize);
+	mGUIMidiQueue.Resize(kGUIMidiQueueSize);
+
+	mNProcessEvents = 0;
+
+	mTailSize = -1;
+	mSilentFrames = 0;
+	mSilentInputs = 0;
+	mOutputSilent = false;
+
 	mInData.Resize(nInputs);
 	nInputs = mInData.GetSize();
+	mInSubData.Resize(nInputs);
 
 	mOutData.Resize(nOutputs);
 	nOutputs = mOutData.GetSize();
+	mOutSubData.Resize(nOutputs);
+
+	if (DoesSingleReplacing())
+	{
+		mInFData.Resize(nInputs);
+		mInSubFData.Resize(nInputs);
+		mOutFData.Resize(nOutputs);
+		mOutSubFData.Resize(nOutputs);
+	}
 
 	const double** const ppInData = mInData.Get();
 	for (int i = 0; i < nInputs; ++i)
@@ -213,6 +328,18 @@ void IPlugBase::SetBlockSize(int blockSize)
 			blockSize = 0;
 	}
 
+	if (DoesSingleReplacing())
+	{
+		// Input buffers followed by output buffers.
+		const int size = (nIn + nOut) * blockSize;
+		float* const pScratch = mFScratchBuf.ResizeOK(size);
+
+		if (pScratch)
+			memset(pScratch, 0, size * sizeof(float));
+		else
+			blockSize = 0;
+	}
+
 	mBlockSize = blockSize;
 }
 
@@ -258,6 +385,18 @@ void IPlugBase::AttachInputBuffers(const int idx, int n, const float* const* ppD
 	int iEnd = mInChannels.GetSize();
 	iEnd = wdl_min(n, iEnd);
 
+	if (DoesSingleReplacing())
+	{
+		const float** const ppInFData = mInFData.Get();
+		const float* const pScratch = mFScratchBuf.Get();
+
+		for (int i = idx; i < iEnd; ++i)
+		{
+			ppInFData[i] = mInChannels.Get(i)->mConnected ? *ppData++ : &pScratch[i * mBlockSize];
+		}
+		return;
+	}
+
 	for (int i = idx; i < iEnd; ++i)
 	{
 		InChannel* const pInChannel = mInChannels.Get(i);
@@ -286,6 +425,26 @@ void IPlugBase::AttachOutputBuffers(const int idx, int n, float* const* ppData)
 	int iEnd = mOutChannels.GetSize();
 	iEnd = wdl_min(n, iEnd);
 
+	if (DoesSingleReplacing())
+	{
+		float** const ppOutFData = mOutFData.Get();
+		float* const pScratch = &mFScratchBuf.Get()[NInChannels() * mBlockSize];
+
+		for (int i = idx; i < iEnd; ++i)
+		{
+			OutChannel* const pOutChannel = mOutChannels.Get(i);
+			if (pOutChannel->mConnected)
+			{
+				ppOutFData[i] = pOutChannel->mFDest = *ppData++;
+			}
+			else
+			{
+				ppOutFData[i] = &pScratch[i * mBlockSize];
+			}
+		}
+		return;
+	}
+
 	for (int i = idx; i < iEnd; ++i)
 	{
 		mOutChannels.Get(i)->AttachScratchBuffer(ppData);
@@ -294,24 +453,187 @@ void IPlugBase::AttachOutputBuffers(const int idx, int n, float* const* ppData)
 
 // Reminder: Lock mutex before calling into any IPlugBase processing functions.
 
+void IPlugBase::ProcessBuffers(double /* sampleType */, const int nFrames)
+{
+	BeginProcessStats();
+
+	if (!SkipSilentBuffers((double)0.0, nFrames))
+	{
+		ProcessDoubleReplacing(mInData.Get(), mOutData.Get(), nFrames);
+	}
+
+	EndProcessStats(nFrames);
+}
+
 void IPlugBase::ProcessBuffers(float /* sampleType */, const int nFrames)
 {
-	ProcessDoubleReplacing(mInData.Get(), mOutData.Get(), nFrames);
+	BeginProcessStats();
+
+	if (SkipSilentBuffers((float)0.0f, nFrames))
+	{
+		// Outputs already zeroed.
+	}
+	else if (DoesSingleReplacing())
+	{
+		ProcessSingleReplacing(mInFData.Get(), mOutFData.Get(), nFrames);
+	}
+	else
+	{
+		ProcessDoubleReplacing(mInData.Get(), mOutData.Get(), nFrames);
+		CastOutputBuffers((float)0.0f, nFrames);
+	}
+
+	EndProcessStats(nFrames);
+}
+
+template <class SAMPLETYPE>
+static bool IsSilent(const SAMPLETYPE* const pData, const int nFrames)
+{
+	for (int i = 0; i < nFrames; ++i)
+	{
+		if (pData[i] != (SAMPLETYPE)0) return false;
+	}
+	return true;
+}
+
+template <class SAMPLETYPE>
+bool IPlugBase::InputsSilent(const SAMPLETYPE* const* const ppData, const int nFrames)
+{
+	const WDL_UINT64 silentMask = mSilentInputs;
+	mSilentInputs = 0;
+
+	if (mTailSize < 0 || mNProcessEvents) return false;
+
+	const int n = NInChannels();
+	const InChannel* const* const ppInChannel = mInChannels.GetList();
+
+	for (int i = 0; i < n; ++i)
+	{
+		if (i < 64 && (silentMask >> i) & 1) continue;
+		if (ppInChannel[i]->mConnected && !IsSilent(ppData[i], nFrames)) return false;
+	}
+
+	return true;
+}
+
+bool IPlugBase::UpdateSilence(const bool inputsSilent, const int nFrames)
+{
+	if (!inputsSilent)
+	{
+		mSilentFrames = 0;
+		return mOutputSilent = false;
+	}
+
+	// Output is silent if whole block is past tail.
+	const WDL_INT64 silentFrames = mSilentFrames;
+	mSilentFrames = silentFrames + nFrames;
+
+	return mOutputSilent = silentFrames >= (WDL_INT64)mTailSize + mLatency;
+}
+
+bool IPlugBase::SkipSilentBuffers(double /* sampleType */, const int nFrames)
+{
+	if (!UpdateSilence(InputsSilent(mInData.Get(), nFrames), nFrames)) return false;
+
 	const int n = NOutChannels();
-	const OutChannel* const* const ppOutChannel = mOutChannels.GetList();
+	double* const* const ppOutData = mOutData.Get();
+
 	for (int i = 0; i < n; ++i)
 	{
-		const OutChannel* const pOutChannel = ppOutChannel[i];
-		if (pOutChannel->mConnected)
+		memset(ppOutData[i], 0, nFrames * sizeof(double));
+	}
+
+	return true;
+}
+
+bool IPlugBase::SkipSilentBuffers(float /* sampleType */, const int nFrames)
+{
+	if (!DoesSingleReplacing())
+	{
+		// Inputs have been cast to double scratch buffers.
+		if (!UpdateSilence(InputsSilent(mInData.Get(), nFrames), nFrames)) return false;
+
+		const int n = NOutChannels();
+		const OutChannel* const* const ppOutChannel = mOutChannels.GetList();
+
+		for (int i = 0; i < n; ++i)
 		{
-			CastCopy(pOutChannel->mFDest, *pOutChannel->mDest, nFrames);
+			const OutChannel* const pOutChannel = ppOutChannel[i];
+			if (pOutChannel->mConnected)
+			{
+				memset(pOutChannel->mFDest, 0, nFrames * sizeof(float));
+			}
 		}
+
+		return true;
+	}
+
+	if (!UpdateSilence(InputsSilent(mInFData.Get(), nFrames), nFrames)) return false;
+
+	const int n = NOutChannels();
+	float* const* const ppOutFData = mOutFData.Get();
+
+	for (int i = 0; i < n; ++i)
+	{
+		memset(ppOutFData[i], 0, nFrames * sizeof(float));
 	}
+
+	return true;
 }
 
-void IPlugBase::ProcessBuffersAccumulating(float /* sampleType */, const int nFrames)
+template <class T>
+static const T* OffsetChannelPtrs(const WDL_TypedBuf<T>* const pSrc, WDL_TypedBuf<T>* const pDest, const int ofs)
 {
-	ProcessDoubleReplacing(mInData.Get(), mOutData.Get(), nFrames);
+	const int n = pDest->GetSize();
+	const T* const ppSrc = pSrc->Get();
+	T* const ppDest = pDest->Get();
+
+	for (int i = 0; i < n; ++i)
+	{
+		ppDest[i] = ppSrc[i] + ofs;
+	}
+
+	return ppDest;
+}
+
+void IPlugBase::ProcessSubBlock(double /* sampleType */, const int startPos, const int nFrames)
+{
+	if (!startPos)
+	{
+		ProcessDoubleReplacing(mInData.Get(), mOutData.Get(), nFrames);
+		return;
+	}
+
+	const double* const* const inputs = OffsetChannelPtrs(&mInData, &mInSubData, startPos);
+	double* const* const outputs = OffsetChannelPtrs(&mOutData, &mOutSubData, startPos);
+
+	ProcessDoubleReplacing(inputs, outputs, nFrames);
+}
+
+void IPlugBase::ProcessSubBlock(float /* sampleType */, const int startPos, const int nFrames)
+{
+	if (!DoesSingleReplacing())
+	{
+		ProcessSubBlock((double)0.0, startPos, nFrames);
+		return;
+	}
+
+	if (!startPos)
+	{
+		ProcessSingleReplacing(mInFData.Get(), mOutFData.Get(), nFrames);
+		return;
+	}
+
+	const float* const* const inputs = OffsetChannelPtrs(&mInFData, &mInSubFData, startPos);
+	float* const* const outputs = OffsetChannelPtrs(&mOutFData, &mOutSubFData, startPos);
+
+	ProcessSingleReplacing(inputs, outputs, nFrames);
+}
+
+void IPlugBase::CastOutputBuffers(float /* sampleType */, const int nFrames)
+{
+	if (DoesSingleReplacing()) return;
+
 	const int n = NOutChannels();
 	const OutChannel* const* const ppOutChannel = mOutChannels.GetList();
 	for (int i = 0; i < n; ++i)
@@ -319,24 +641,93 @@ void IPlugBase::ProcessBuffersAccumulating(float /* sampleType */, const int nFr
 		const OutChannel* const pOutChannel = ppOutChannel[i];
 		if (pOutChannel->mConnected)
 		{
-			CastCopyAccumulating(pOutChannel->mFDest, *pOutChannel->mDest, nFrames);
+			CastCopy(pOutChannel->mFDest, *pOutChannel->mDest, nFrames);
+		}
+	}
+}
+
+void IPlugBase::ProcessBuffersAccumulating(float /* sampleType */, const int nFrames)
+{
+	BeginProcessStats();
+	UpdateSilence(false, nFrames); // Always process.
+
+	if (DoesSingleReplacing())
+	{
+		// Process into scratch buffers, then add to host buffers.
+		const int n = NOutChannels();
+		float** const ppOutFData = mOutFData.Get();
+		float* const pScratch = &mFScratchBuf.Get()[NInChannels() * mBlockSize];
+
+		for (int i = 0; i < n; ++i)
+		{
+			ppOutFData[i] = &pScratch[i * mBlockSize];
+		}
+
+		ProcessSingleReplacing(mInFData.Get(), ppOutFData, nFrames);
+
+		// Add to host buffers, and reattach them (see AttachOutputBuffers()).
+		const OutChannel* const* const ppOutChannel = mOutChannels.GetList();
+		for (int i = 0; i < n; ++i)
+		{
+			const OutChannel* const pOutChannel = ppOutChannel[i];
+			if (pOutChannel->mConnected)
+			{
+				CastCopyAccumulating(pOutChannel->mFDest, ppOutFData[i], nFrames);
+				ppOutFData[i] = pOutChannel->mFDest;
+			}
+		}
+	}
+	else
+	{
+		ProcessDoubleReplacing(mInData.Get(), mOutData.Get(), nFrames);
+		const int n = NOutChannels();
+		const OutChannel* const* const ppOutChannel = mOutChannels.GetList();
+		for (int i = 0; i < n; ++i)
+		{
+			const OutChannel* const pOutChannel = ppOutChannel[i];
+			if (pOutChannel->mConnected)
+			{
+				CastCopyAccumulating(pOutChannel->mFDest, *pOutChannel->mDest, nFrames);
+			}
 		}
 	}
+
+	EndProcessStats(nFrames);
+}
+
+void IPlugBase::PassThroughBuffers(double /* sampleType */, const int nFrames)
+{
+	BeginProcessStats();
+	UpdateSilence(false, nFrames);
+	ProcessDoubleReplacing(mInData.Get(), mOutData.Get(), nFrames);
+	EndProcessStats(nFrames);
 }
 
 void IPlugBase::PassThroughBuffers(float /* sampleType */, const int nFrames)
 {
-	IPlugBase::ProcessDoubleReplacing(mInData.Get(), mOutData.Get(), nFrames);
-	const int n = NOutChannels();
-	const OutChannel* const* const ppOutChannel = mOutChannels.GetList();
-	for (int i = 0; i < n; ++i)
+	BeginProcessStats();
+	UpdateSilence(false, nFrames);
+
+	if (DoesSingleReplacing())
 	{
-		const OutChannel* const pOutChannel = ppOutChannel[i];
-		if (pOutChannel->mConnected)
+		IPlugBase::ProcessSingleReplacing(mInFData.Get(), mOutFData.Get(), nFrames);
+	}
+	else
+	{
+		IPlugBase::ProcessDoubleReplacing(mInData.Get(), mOutData.Get(), nFrames);
+		const int n = NOutChannels();
+		const OutChannel* const* const ppOutChannel = mOutChannels.GetList();
+		for (int i = 0; i < n; ++i)
 		{
-			CastCopy(pOutChannel->mFDest, *pOutChannel->mDest, nFrames);
+			const OutChannel* const pOutChannel = ppOutChannel[i];
+			if (pOutChannel->mConnected)
+			{
+				CastCopy(pOutChannel->mFDest, *pOutChannel->mDest, nFrames);
+			}
 		}
 	}
+
+	EndProcessStats(nFrames);
 }
 
 bool IPlugBase::MidiNoteName(int /* noteNumber */, char* const buf, const int bufSize)
@@ -358,21 +749,103 @@ bool IPlugBase::SendMidiMsgs(const IMidiMsg* const pMsgs, const int n)
 
 void IPlugBase::SetParameterFromGUI(const int idx, const double normalizedValue)
 {
+	// While processing, don't lock mutex (which could stall audio thread
+	// while OnParamChange() runs), but queue change for audio thread.
+	if (mGUIQueueEnabled)
+	{
+		const GUIParamChange change = { idx, normalizedValue };
+		if (mGUIParamQueue.Push(change))
+		{
+			// Param itself is updated later, but make new (clamped) value
+			// available to host right away.
+			GetParam(idx)->SetAtomicNormalized(normalizedValue);
+
+			InformHostOfQueuedParamChange(idx, normalizedValue);
+			return;
+		}
+	}
+
 	mMutex.Enter();
 
+	// Apply any queued changes first, to keep changes in order.
+	ProcessGUIParamChanges();
+
 	GetParam(idx)->SetNormalized(normalizedValue);
+
 	InformHostOfParamChange(idx, normalizedValue, false);
 	OnParamChange(idx);
 
 	mMutex.Leave();
 }
 
+bool IPlugBase::SendMidiMsgFromGUI(const IMidiMsg* const pMsg)
+{
+	IMidiMsg msg = *pMsg;
+	msg.mOffset = 0;
+
+	// Same as SetParameterFromGUI(), so GUI never stalls audio thread.
+	if (mGUIQueueEnabled)
+	{
+		const bool ok = mGUIMidiQueue.Push(msg);
+		if (ok) RequestProcess();
+		return ok;
+	}
+
+	mMutex.Enter();
+
+	// Apply any queued changes first, to keep changes in order.
+	ProcessGUIParamChanges();
+	ProcessMidiMsg(&msg);
+
+	mMutex.Leave();
+	return true;
+}
+
+void IPlugBase::EnableGUIParamQueue(const bool enable)
+{
+	#ifndef IPLUG_NO_GUI_PARAM_QUEUE
+	// Disable first, so GUI thread doesn't queue anything after draining.
+	mGUIQueueEnabled = enable;
+	if (!enable) ProcessGUIParamChanges();
+	#endif
+}
+
+void IPlugBase::DrainGUIParamQueue()
+{
+	// Mutex is already locked.
+	GUIParamChange change;
+	while (mGUIParamQueue.Pop(&change))
+	{
+		const int idx = change.mIdx;
+		GetParam(idx)->SetNormalized(change.mNormalizedValue);
+		OnParamChange(idx);
+	}
+}
+
+void IPlugBase::ProcessGUIParamChanges()
+{
+	// Mutex is already locked.
+	DrainGUIParamQueue();
+
+	IMidiMsg msg;
+	int nMsgs = 0;
+
+	while (mGUIMidiQueue.Pop(&msg))
+	{
+		ProcessMidiMsg(&msg);
+		++nMsgs;
+	}
+
+	CountProcessEvents(nMsgs);
+}
+
 void IPlugBase::OnParamReset()
 {
+	const double* const pPrev = mpPrevParamValues;
 	const int n = mParams.GetSize();
 	for (int i = 0; i < n; ++i)
 	{
-		OnParamChange(i);
+		if (!pPrev || mParams.Get(i)->GetNormalized() != pPrev[i]) OnParamChange(i);
 	}
 }
 
@@ -453,6 +926,24 @@ void IPlugBase::ProcessDoubleReplacing(const double* const* const inputs, double
 	}
 }
 
+void IPlugBase::ProcessSingleReplacing(const float* const* const inputs, float* const* const outputs, const int nFrames)
+{
+	assert(nFrames >= 0);
+	const size_t byteSize = nFrames * sizeof(float);
+
+	// Mutex is already locked.
+	const int nIn = mInChannels.GetSize(), nOut = mOutChannels.GetSize();
+	int i = 0;
+	for (int n = wdl_min(nIn, nOut); i < n; ++i)
+	{
+		memcpy(outputs[i], inputs[i], byteSize);
+	}
+	for (/* same i */; i < nOut; ++i)
+	{
+		memset(outputs[i], 0, byteSize);
+	}
+}
+
 bool IPlugBase::AllocPresetChunk(int chunkSize)
 {
 	if (chunkSize < 0)
@@ -604,6 +1095,40 @@ void IPlugBase::EnsureDefaultPreset()
 	}
 }
 
+#ifndef IPLUG_NO_PROCESS_STATS
+
+void IPlugBase::DumpProcessStats(WDL_FastString* const pStr) const
+{
+	IProcessStats::Stats stats;
+	mProcessStats.GetStats(&stats);
+
+	pStr->AppendFormatted(mEffectName.GetLength() + 192,
+		"%s (%p): %u blocks, %u misses, load last %.1f%%, p50 %.1f%%, p90 %.1f%%, p99 %.1f%%, max %.1f%%\n",
+		mEffectName.Get(), (const void*)this, stats.mNBlocks, stats.mNMisses,
+		100.0 * stats.mLast, 100.0 * stats.mP50, 100.0 * stats.mP90, 100.0 * stats.mP99, 100.0 * stats.mMax);
+
+	IProcessStats::Block blocks[IProcessStats::kNumWorstBlocks];
+	const int n = mProcessStats.GetWorstBlocks(blocks, IProcessStats::kNumWorstBlocks);
+
+	for (int i = 0; i < n; ++i)
+	{
+		const IProcessStats::Block* const pBlock = &blocks[i];
+		pStr->AppendFormatted(96, "  block %u: load %.1f%%, %d frames, %d events\n",
+			pBlock->mBlockIdx, 100.0 * pBlock->mLoad, pBlock->mNFrames, pBlock->mNEvents);
+	}
+}
+
+#ifndef NDEBUG
+void IPlugBase::DumpProcessStats() const
+{
+	WDL_FastString str;
+	DumpProcessStats(&str);
+	IPlugDebugLog(str.Get());
+}
+#endif
+
+#endif // IPLUG_NO_PROCESS_STATS
+
 void IPlugBase::PruneUninitializedPresets()
 {
 	int i = 0;
@@ -624,6 +1149,8 @@ bool IPlugBase::RestorePreset(int idx)
 	IPreset* const pPreset = mPresets.Get(idx);
 	if (pPreset)
 	{
+		DrainGUIParamQueue();
+
 		if (!pPreset->mInitialized)
 		{
 			InitPresetChunk(pPreset);
@@ -632,6 +1159,18 @@ bool IPlugBase::RestorePreset(int idx)
 		}
 		else
 		{
+			#ifndef IPLUG_NO_INCREMENTAL_RESTORE
+			// Remember current values, so OnParamReset() and
+			// RedrawParamControls() can skip unchanged parameters.
+			const int n = mParams.GetSize();
+			double* const pPrev = mPrevParamValues.Resize(n, false);
+			if (pPrev && mPrevParamValues.GetSize() == n)
+			{
+				for (int i = 0; i < n; ++i) pPrev[i] = mParams.Get(i)->GetNormalized();
+				mpPrevParamValues = pPrev;
+			}
+			#endif
+
 			restoredOK = UnserializePreset(&pPreset->mChunk, 0) >= 0;
 			OnParamReset();
 		}
@@ -642,6 +1181,8 @@ bool IPlugBase::RestorePreset(int idx)
 			mCurrentPresetIdx = idx;
 			RedrawParamControls();
 		}
+
+		mpPrevParamValues = NULL;
 	}
 	return restoredOK;
 }
@@ -711,6 +1252,14 @@ bool IPlugBase::SerializePresets(const int fromIdx, const int toIdx, ByteChunk*
 
 int IPlugBase::UnserializePresets(const int fromIdx, const int toIdx, const ByteChunk* const pChunk, int pos, const int version)
 {
+	// UnserializePreset() validates each preset, but changes parameters,
+	// so back them up, and silently restore them afterwards. Caller calls
+	// RestorePreset(), which calls OnParamChange() for params that differ
+	// from the restored values.
+	ByteChunk backup;
+	backup.SetGrowable();
+	const bool backedUp = backup.Alloc(wdl_max(mPresetChunkSize, 0)) >= 0 && SerializePreset(&backup);
+
 	for (int i = fromIdx; i < toIdx && pos >= 0; ++i)
 	{
 		IPreset* const pPreset = mPresets.Get(i);
@@ -718,18 +1267,37 @@ int IPlugBase::UnserializePresets(const int fromIdx, const int toIdx, const Byte
 		pos = pChunk->GetBool(&pPreset->mInitialized, pos);
 		if (pPreset->mInitialized)
 		{
+			const int startPos = pos;
 			pos = UnserializePreset(pChunk, pos, version);
-			OnParamReset();
-			if (pos >= 0)
-			{
-				pPreset->mChunk.Clear();
-				SerializePreset(&pPreset->mChunk);
-			}
+			if (pos >= 0) CopyPresetChunk(pPreset, pChunk, startPos, pos, version);
 		}
 	}
+
+	if (backedUp) UnserializePreset(&backup, 0);
 	return pos;
 }
 
+void IPlugBase::CopyPresetChunk(IPreset* const pPreset, const ByteChunk* const pChunk, const int startPos, const int endPos, const int version)
+{
+	ByteChunk* const pDest = &pPreset->mChunk;
+	const int size = endPos - startPos;
+	const void* pData;
+
+	// Copy data as is, unless older version (or no longer in stream
+	// buffer), in which case convert it by serializing parameters.
+	if (!version && pChunk->GetBuf(&pData, size, startPos) >= 0 &&
+		(pDest->AllocSize() >= size || pDest->Alloc(size) >= size))
+	{
+		pDest->Clear();
+		pDest->PutBytes(pData, size);
+	}
+	else
+	{
+		pDest->Clear();
+		SerializePreset(pDest);
+	}
+}
+
 bool IPlugBase::SerializeBank(ByteChunk* const pChunk)
 {
 	bool savedOK = true;
@@ -744,11 +1312,18 @@ bool IPlugBase::SerializeBank(ByteChunk* const pChunk)
 
 int IPlugBase::UnserializeBank(const ByteChunk* const pChunk, int pos)
 {
+	// Global params aren't in presets, so RestorePreset() won't see them
+	// change, so call OnParamChange() for changed globals here (also if
+	// bank fails partway).
 	const int n = mParams.GetSize();
 	for (int i = 0; i < n && pos >= 0; ++i)
 	{
 		IParam* const pParam = mParams.Get(i);
-		if (pParam->IsGlobal()) pos = pParam->Unserialize(pChunk, pos);
+		if (!pParam->IsGlobal()) continue;
+
+		const double prev = pParam->GetNormalized();
+		pos = pParam->Unserialize(pChunk, pos);
+		if (pParam->GetNormalized() != prev) OnParamChange(i);
 	}
 	return pos >= 0 ? UnserializePresets(0, NPresets(), pChunk, pos) : pos;
 }
@@ -819,11 +1394,12 @@ void IPlugBase::RedrawParamControls()
 {
 	if (mGraphics)
 	{
+		const double* const pPrev = mpPrevParamValues;
 		const int n = mParams.GetSize();
 		for (int i = 0; i < n; ++i)
 		{
 			const double v = mParams.Get(i)->GetNormalized();
-			mGraphics->SetParameterFromPlug(i, v, true);
+			if (!pPrev || v != pPrev[i]) mGraphics->SetParameterFromPlug(i, v, true);
 		}
 	}
 }
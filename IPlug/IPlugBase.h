@@ -3,6 +3,7 @@
 #include "Containers.h"
 #include "IPlugStructs.h"
 #include "IParam.h"
+#include "IProcessStats.h"
 
 #include <assert.h>
 
@@ -22,6 +23,11 @@ public:
 	static const int kDefaultSampleRate = 44100;
 	static const int kDefaultBlockSize = 1024;
 
+	// Max GUI parameter changes queued between process calls.
+	static const int kGUIParamQueueSize = 256;
+	// Max GUI MIDI messages queued between process calls.
+	static const int kGUIMidiQueueSize = 256;
+
 	// Use IPLUG_CTOR instead of calling directly (defined in IPlug_include_in_plug_hdr.h).
 	IPlugBase(
 		int nParams,
@@ -43,7 +49,11 @@ public:
 
 		kPlugDoesMidiIn = 2,
 		kPlugDoesMidiOut = 4,
-		kPlugDoesMidi = kPlugDoesMidiIn | kPlugDoesMidiOut
+		kPlugDoesMidi = kPlugDoesMidiIn | kPlugDoesMidiOut,
+
+		// Call ProcessSingleReplacing() directly with host float buffers,
+		// instead of converting to/from double for ProcessDoubleReplacing().
+		kPlugDoesSingleReplacing = 512
 	};
 
 	// ----------------------------------------
@@ -61,6 +71,11 @@ public:
 	// Mutex is already locked.
 	virtual void ProcessDoubleReplacing(const double* const* inputs, double* const* outputs, int nFrames);
 
+	// Only called for float host buffers if kPlugDoesSingleReplacing,
+	// otherwise same as above. Note that double hosts will still call
+	// ProcessDoubleReplacing().
+	virtual void ProcessSingleReplacing(const float* const* inputs, float* const* outputs, int nFrames);
+
 	// Call GetGUI()->Rescale(wantScale) to set scale, then load bitmaps
 	// that depend on GUI size. Return true to notify controls of rescale.
 	virtual bool OnGUIRescale(int wantScale); // See IGraphics::EGUIScale.
@@ -107,7 +122,9 @@ public:
 	virtual int UnserializeState(const ByteChunk* pChunk, int startPos);
 
 	// By default serializes global parameters, followed by each preset
-	// (in SerializePreset() format, but with extra info).
+	// (in SerializePreset() format, but with extra info). UnserializeBank()
+	// calls OnParamChange() for changed global parameters, but only loads
+	// presets, so call RestorePreset() afterwards to apply current preset.
 	virtual bool SerializeBank(ByteChunk* pChunk);
 	virtual int UnserializeBank(const ByteChunk* pChunk, int startPos);
 
@@ -185,9 +202,19 @@ public:
 	inline int GetUniqueID() const { return mUniqueID; }
 	inline int GetMfrID() const { return mMfrID; }
 
+	// Call from GUI thread only. While processing the change is queued, and
+	// applied by the audio thread (see ProcessGUIParamChanges()).
 	void SetParameterFromGUI(int idx, double normalizedValue);
 
-	virtual void OnParamReset(); // Calls OnParamChange(each param).
+	// Call from GUI thread only (e.g. on-screen keyboard). While processing
+	// the message is queued, and passed to ProcessMidiMsg() by the audio
+	// thread at the start of the next block (offset 0, so before any host
+	// MIDI). Returns false if queue is full.
+	bool SendMidiMsgFromGUI(const IMidiMsg* pMsg);
+
+	// Calls OnParamChange(each param). When called from RestorePreset(),
+	// only calls it for changed parameters (unless IPLUG_NO_INCREMENTAL_RESTORE).
+	virtual void OnParamReset();
 	void RedrawParamControls(); // Called after restoring state.
 
 	// If a parameter change comes from the GUI, midi, or external input,
@@ -209,6 +236,10 @@ public:
 	inline double GetSampleRate() const { return mSampleRate; }
 	inline int GetBlockSize() const { return mBlockSize; }
 	inline int GetLatency() const { return mLatency; }
+
+	// Samples of output after inputs (and MIDI) went silent, not including
+	// latency, or -1 if unknown/infinite (default). See SetTailSize().
+	inline int GetTailSize() const { return mTailSize; }
   
 	// In ProcessDoubleReplacing you are always guaranteed to get valid pointers
 	// to all the channels the plugin requested.  If the host hasn't connected all the pins,
@@ -258,6 +289,21 @@ public:
     
 	void EnsureDefaultPreset();
 
+	// Per-block process time statistics, disabled by default. Enable with
+	// GetProcessStats()->Enable(true), then poll from GUI thread. Define
+	// IPLUG_NO_PROCESS_STATS to compile out.
+	#ifndef IPLUG_NO_PROCESS_STATS
+	inline IProcessStats* GetProcessStats() { return &mProcessStats; }
+
+	// Appends stats and worst blocks as text, prefixed by effect name and
+	// instance address (so you can tell instances apart).
+	void DumpProcessStats(WDL_FastString* pStr) const;
+
+	#ifndef NDEBUG
+	void DumpProcessStats() const; // To debug log.
+	#endif
+	#endif
+
 	#ifndef NDEBUG
 	static void DebugLog(const char* format, ...);
 	#else
@@ -321,6 +367,12 @@ protected:
 	virtual void SetBlockSize(int blockSize);
 	// If latency changes after initialization (often not supported by the host).
 	virtual void SetLatency(const int samples) { mLatency = samples; }
+	// If >= 0, then once inputs have been silent for tail size + latency,
+	// and there have been no input events, ProcessDoubleReplacing() is no
+	// longer called and outputs are zeroed (and wrappers tell the host they
+	// are silent). Set to -1 while output doesn't only depend on input, e.g.
+	// while notes are held or for LFO/noise generators.
+	virtual void SetTailSize(const int samples) { mTailSize = samples; }
 
 	virtual bool SendMidiMsg(const IMidiMsg* pMsg) = 0;
 	virtual bool SendMidiMsgs(const IMidiMsg* pMsgs, int n);
@@ -333,6 +385,8 @@ protected:
 		return !!(mPlugFlags & plugDoes);
 	}
 
+	inline bool DoesSingleReplacing() const { return !!(mPlugFlags & kPlugDoesSingleReplacing); }
+
 	// MakePreset(name, param1, param2, ..., paramN)
 	bool MakePreset(const char* name, ...);
 	// MakePresetFromNamedParams(name, nParamsNamed, paramEnum1, paramVal1, paramEnum2, paramVal2, ..., paramEnumN, paramVal2)
@@ -374,8 +428,11 @@ protected:
 	void ModifyCurrentPreset(const char* name = NULL); // Sets the currently active preset to whatever current params are.
 
 	bool SerializePresets(int fromIdx, int toIdx /* up to but *not* including */, ByteChunk* pChunk) const;
-	// Returns the new chunk position (endPos).
+	// Returns the new chunk position (endPos). Doesn't change parameters
+	// (and so doesn't call OnParamChange()), so call RestorePreset()
+	// afterwards to apply current preset.
 	int UnserializePresets(int fromIdx, int toIdx, const ByteChunk* pChunk, int startPos, int version = 0);
+	void CopyPresetChunk(IPreset* pPreset, const ByteChunk* pChunk, int startPos, int endPos, int version);
 
 	#ifndef NDEBUG
 	// Dump the current state as source code for a call to MakePresetFromNamedParams().
@@ -390,22 +447,109 @@ protected:
 
 	void AttachInputBuffers(int idx, int n, const double* const* ppData, int nFrames);
 	void AttachOutputBuffers(int idx, int n, double* const* ppData);
-	void ProcessBuffers(double /* sampleType */, const int nFrames) { ProcessDoubleReplacing(mInData.Get(), mOutData.Get(), nFrames); }
-	void PassThroughBuffers(double /* sampleType */, const int nFrames) { ProcessDoubleReplacing(mInData.Get(), mOutData.Get(), nFrames); }
+	void ProcessBuffers(double /* sampleType */, int nFrames);
+	void PassThroughBuffers(double /* sampleType */, int nFrames);
 	void AttachInputBuffers(int idx, int n, const float* const* ppData, int nFrames);
 	void AttachOutputBuffers(int idx, int n, float* const* ppData);
 	void ProcessBuffers(float /* sampleType */, int nFrames);
 	void ProcessBuffersAccumulating(float /* sampleType */, int nFrames);
 	void PassThroughBuffers(float /* sampleType */, int nFrames);
 
+	// Processes part of the attached buffers, starting at sample offset
+	// startPos (e.g. to split block at parameter changes). For float
+	// buffers call CastOutputBuffers() after processing the whole block.
+	void ProcessSubBlock(double /* sampleType */, int startPos, int nFrames);
+	void ProcessSubBlock(float /* sampleType */, int startPos, int nFrames);
+	void CastOutputBuffers(float /* sampleType */, int nFrames);
+
+	// Applies parameter changes queued by SetParameterFromGUI(), and passes
+	// MIDI queued by SendMidiMsgFromGUI() to ProcessMidiMsg(). Lock mutex
+	// before calling.
+	void ProcessGUIParamChanges();
+
+	// Applies parameter changes queued by SetParameterFromGUI() (but not
+	// MIDI). Call before restoring preset or state, else queued changes
+	// would overwrite it. Lock mutex before calling.
+	void DrainGUIParamQueue();
+
+	// Wrappers that call ProcessGUIParamChanges() for each process call
+	// enable GUI queue when activated, and disable it (which also applies
+	// queued changes) when deactivated. Does nothing if
+	// IPLUG_NO_GUI_PARAM_QUEUE is defined. Lock mutex before calling.
+	void EnableGUIParamQueue(bool enable);
+
+	// Called by SetParameterFromGUI() on GUI thread, without mutex locked,
+	// after change has been queued. Default calls InformHostOfParamChange()
+	// with lockMutex = false; override if that isn't thread-safe.
+	virtual void InformHostOfQueuedParamChange(const int idx, const double normalizedValue)
+	{
+		InformHostOfParamChange(idx, normalizedValue, false);
+	}
+
+	// Called after SendMidiMsgFromGUI() queued message, so wrapper can wake
+	// up host if plugin is sleeping (see SetTailSize()).
+	virtual void RequestProcess() {}
+
+	// ProcessBuffers() etc. time themselves, but wrappers can start timing
+	// earlier to include event handling, and should count input events
+	// (also used for silence detection). Call EndProcessStats() explicitly
+	// only if not using ProcessBuffers() (e.g. ProcessSubBlock()).
+	#ifndef IPLUG_NO_PROCESS_STATS
+	inline void BeginProcessStats() { if (mProcessStats.IsEnabled()) mProcessStats.Begin(); }
+	inline void EndProcessStats(const int nFrames) { mProcessStats.End(nFrames, mSampleRate, mNProcessEvents); mNProcessEvents = 0; }
+	#else
+	inline void BeginProcessStats() {}
+	inline void EndProcessStats(int /* nFrames */) { mNProcessEvents = 0; }
+	#endif
+
+	// Input events wake up plugin, see SetTailSize().
+	inline void CountProcessEvents(const int n)
+	{
+		if (!n) return;
+		mNProcessEvents += n;
+		mSilentFrames = 0;
+		mOutputSilent = false;
+	}
+
+	// Silence detection, only if tail size >= 0. Wrapper can set input
+	// channels known to be silent (bit per channel, e.g. from host silence
+	// flags) before calling ProcessBuffers(), other connected inputs are
+	// scanned.
+	inline void SetSilentInputs(const WDL_UINT64 mask) { mSilentInputs = mask; }
+
+	// After ProcessBuffers(): inputs were silent (so tail is playing).
+	inline bool IsInputSilent() const { return mSilentFrames > 0; }
+	// After ProcessBuffers(): processing was skipped, outputs are silent.
+	inline bool IsOutputSilent() const { return mOutputSilent; }
+
+	// Called by ProcessBuffers(). Returns true if tail has elapsed, in
+	// which case outputs have been zeroed, and processing can be skipped.
+	bool SkipSilentBuffers(double /* sampleType */, int nFrames);
+	bool SkipSilentBuffers(float /* sampleType */, int nFrames);
+
 	virtual void InformHostOfParamChanges() {} // See InformHostOfParamReset().
 
 	WDL_PtrList_DeleteOnDestroy<IParam> mParams;
 	WDL_PtrList_DeleteOnDestroy<IPreset> mPresets;
 	int mCurrentPresetIdx, mParamChangeIdx;
 
+	// Normalized values before RestorePreset(), or NULL.
+	WDL_TypedBuf<double> mPrevParamValues;
+	const double* mpPrevParamValues;
+
 	WDL_Mutex mMutex;
 
+	struct GUIParamChange
+	{
+		int mIdx;
+		double mNormalizedValue;
+	};
+	ILockFreeQueue<GUIParamChange> mGUIParamQueue;
+	ILockFreeQueue<IMidiMsg> mGUIMidiQueue;
+
+	// Read by GUI thread without locking mutex, so not in mPlugFlags.
+	std::atomic<bool> mGUIQueueEnabled;
+
 	WDL_FastString mEffectName, mProductName, mMfrName;
 	int mUniqueID, mMfrID, mVersion; // Version stored as 0xVVVVRRMM: V = version, R = revision, M = minor revision.
 
@@ -420,6 +564,16 @@ protected:
 	WDL_TypedBuf<const double*> mInData;
 	WDL_TypedBuf<double*> mOutData;
 
+	// Offset channel pointers, see ProcessSubBlock().
+	WDL_TypedBuf<const double*> mInSubData;
+	WDL_TypedBuf<double*> mOutSubData;
+
+	// Float channel pointers, and buffers for unconnected channels; only
+	// used if kPlugDoesSingleReplacing.
+	WDL_TypedBuf<const float*> mInFData, mInSubFData;
+	WDL_TypedBuf<float*> mOutFData, mOutSubFData;
+	WDL_TypedBuf<float> mFScratchBuf;
+
 	struct InChannel
 	{
 		bool mConnected;
@@ -451,5 +605,18 @@ protected:
 	WDL_PtrList_DeleteOnDestroy<OutChannel> mOutChannels;
 
 	int mPresetChunkSize;
+
+	#ifndef IPLUG_NO_PROCESS_STATS
+	IProcessStats mProcessStats;
+	#endif
+	int mNProcessEvents;
+
+	int mTailSize;
+	WDL_INT64 WDL_FIXALIGN mSilentFrames; // Since inputs went silent.
+	WDL_UINT64 mSilentInputs;
+	bool mOutputSilent;
+
+	template <class SAMPLETYPE> bool InputsSilent(const SAMPLETYPE* const* ppData, int nFrames);
+	bool UpdateSilence(bool inputsSilent, int nFrames);
 }
 WDL_FIXALIGN;
@@ -1,5 +1,6 @@
 #include "IPlugCLAP.h"
 #include "IGraphics.h"
+#include "IChunkCodec.h"
 
 #ifdef __APPLE__
 	#include "IGraphicsMac.h"
@@ -24,21 +25,29 @@ static const char* const sClapWindowAPI =
 	CLAP_WINDOW_API_WIN32;
 #elif defined(__APPLE__)
 	CLAP_WINDOW_API_COCOA;
+#else
+	""; // Headless IGraphics, can't embed in host window.
 #endif
 
+// Wait-free, using atomic value, so also includes queued GUI changes not
+// yet applied to param.
 static double GetParamValue(const IParam* const pParam)
 {
 	switch (pParam->Type())
 	{
 		case IParam::kTypeBool:
-			return (double)((const IBoolParam*)pParam)->Bool();
 		case IParam::kTypeEnum:
-			return (double)((const IEnumParam*)pParam)->Int();
+			return pParam->GetAtomicValue();
 		default:
 			break;
 	}
 
-	return pParam->GetNormalized();
+	return pParam->GetAtomicNormalized();
+}
+
+static bool IsParamValueEvent(const clap_event_header* const pEvent)
+{
+	return pEvent->space_id == CLAP_CORE_EVENT_SPACE_ID && pEvent->type == CLAP_EVENT_PARAM_VALUE;
 }
 
 static int NInOutChannels(const IPlugCLAP* const pPlug, const bool isInput)
@@ -94,6 +103,9 @@ IPlugBase(
 	memset(mTimeSig, 0, sizeof(mTimeSig));
 
 	mPushIt = false;
+	mMinSubBlockSize = 0;
+
+	mQueuedParamChanges.Resize(kGUIParamQueueSize);
 
 	mClapPlug.desc = ClapFactoryGetPluginDescriptor(NULL, 0);
 	mClapPlug.plugin_data = this;
@@ -112,6 +124,7 @@ IPlugBase(
 	mClapHost = NULL;
 	mRequestFlush = NULL;
 	mRequestResize = NULL;
+	mTailChanged = NULL;
 
 	mGUIParent = NULL;
 	mGUIWidth = mGUIHeight = 0;
@@ -130,8 +143,13 @@ IPlugBase(
 
 bool IPlugCLAP::AllocStateChunk(int chunkSize)
 {
+	#ifdef IPLUG_STATE_STREAMING
+	// State is streamed (see ClapStateSave()), so no need to preallocate.
+	return true;
+	#else
 	if (chunkSize < 0) chunkSize = GetParamsChunkSize(0, NParams());
 	return mState.Alloc(chunkSize) == chunkSize;
+	#endif
 }
 
 bool IPlugCLAP::AllocBankChunk(const int chunkSize)
@@ -159,6 +177,20 @@ void IPlugCLAP::InformHostOfParamChange(const int idx, double /* normalizedValue
 	if (lockMutex) mMutex.Leave();
 }
 
+void IPlugCLAP::InformHostOfQueuedParamChange(const int idx, const double normalizedValue)
+{
+	// Don't lock mutex, but queue change, and add it to param changes next
+	// time mutex is locked (see AddQueuedParamChanges()).
+	if (mQueuedParamChanges.Push(idx))
+	{
+		if (mRequestFlush) mRequestFlush(mClapHost);
+	}
+	else
+	{
+		InformHostOfParamChange(idx, normalizedValue);
+	}
+}
+
 void IPlugCLAP::EndInformHostOfParamChange(const int idx, const bool lockMutex)
 {
 	if (lockMutex) mMutex.Enter();
@@ -220,6 +252,19 @@ void IPlugCLAP::ResizeGraphics(const int w, const int h)
 	}
 }
 
+void IPlugCLAP::RequestProcess()
+{
+	if (mClapHost) mClapHost->request_process(mClapHost);
+}
+
+void IPlugCLAP::SetTailSize(const int samples)
+{
+	if (samples == GetTailSize()) return;
+
+	IPlugBase::SetTailSize(samples);
+	if (mTailChanged) mTailChanged(mClapHost);
+}
+
 bool IPlugCLAP::SendMidiMsg(const IMidiMsg* const pMsg)
 {
 	mMutex.Enter();
@@ -276,62 +321,108 @@ void IPlugCLAP::ProcessInputEvents(const clap_input_events* const pInEvents, con
 		const uint32_t ofs = pEvent->time;
 		if (ofs >= nFrames) break;
 
-		if (pEvent->space_id != CLAP_CORE_EVENT_SPACE_ID) continue;
+		ProcessInputEvent(pEvent, ofs);
+	}
+}
 
-		switch (pEvent->type)
-		{
-			case CLAP_EVENT_NOTE_ON:
-			{
-				const clap_event_note* const pNoteOn = (const clap_event_note*)pEvent;
-				if (pNoteOn->port_index != 0) break;
+void IPlugCLAP::ProcessSubBlocks(const clap_input_events* const pInEvents, const uint32_t nEvents, const uint32_t nFrames, const bool is64bits)
+{
+	const uint32_t minFrames = mMinSubBlockSize;
+	uint32_t i = 0, pos = 0;
 
-				int velocity = (int)(pNoteOn->velocity * 127.0 + 0.5);
-				velocity = wdl_max(velocity, 1);
+	while (pos < nFrames)
+	{
+		uint32_t end = nFrames;
 
-				const IMidiMsg msg(ofs, 0x90 | pNoteOn->channel, pNoteOn->key, velocity);
-				ProcessMidiMsg(&msg);
-				break;
-			}
+		for (; i < nEvents; ++i)
+		{
+			const clap_event_header* const pEvent = pInEvents->get(pInEvents, i);
 
-			case CLAP_EVENT_NOTE_OFF:
+			const uint32_t ofs = pEvent->time;
+			if (ofs >= nFrames)
 			{
-				const clap_event_note* const pNoteOff = (const clap_event_note*)pEvent;
-				if (pNoteOff->port_index != 0) break;
-
-				const int velocity = (int)(pNoteOff->velocity * 127.0 + 0.5);
-
-				const IMidiMsg msg(ofs, 0x80 | pNoteOff->channel, pNoteOff->key, velocity);
-				ProcessMidiMsg(&msg);
+				i = nEvents;
 				break;
 			}
 
-			case CLAP_EVENT_PARAM_VALUE:
+			// Split block at parameter change, unless it is too close to
+			// the start of the current sub-block.
+			if (ofs >= pos + minFrames && IsParamValueEvent(pEvent))
 			{
-				ProcessParamEvent((const clap_event_param_value*)pEvent);
+				end = ofs;
 				break;
 			}
 
-			case CLAP_EVENT_MIDI:
-			{
-				const clap_event_midi* const pMidiEvent = (const clap_event_midi*)pEvent;
-				if (pMidiEvent->port_index) break;
+			// Sample offset is relative to start of sub-block.
+			ProcessInputEvent(pEvent, ofs > pos ? ofs - pos : 0);
+		}
+
+		if (is64bits)
+			ProcessSubBlock((double)0.0, pos, end - pos);
+		else
+			ProcessSubBlock((float)0.0f, pos, end - pos);
 
-				IMidiMsg msg(ofs);
-				memcpy(&msg.mStatus, pMidiEvent->data, 3);
+		pos = end;
+	}
+}
 
-				ProcessMidiMsg(&msg);
-				break;
-			}
+void IPlugCLAP::ProcessInputEvent(const clap_event_header* const pEvent, const int ofs)
+{
+	if (pEvent->space_id != CLAP_CORE_EVENT_SPACE_ID) return;
 
-			case CLAP_EVENT_MIDI_SYSEX:
-			{
-				const clap_event_midi_sysex* const pSysExEvent = (const clap_event_midi_sysex*)pEvent;
-				if (pSysExEvent->port_index) break;
+	switch (pEvent->type)
+	{
+		case CLAP_EVENT_NOTE_ON:
+		{
+			const clap_event_note* const pNoteOn = (const clap_event_note*)pEvent;
+			if (pNoteOn->port_index != 0) break;
 
-				const ISysEx sysex(ofs, pSysExEvent->buffer, pSysExEvent->size);
-				if (sysex.mSize >= 0) ProcessSysEx(&sysex);
-				break;
-			}
+			int velocity = (int)(pNoteOn->velocity * 127.0 + 0.5);
+			velocity = wdl_max(velocity, 1);
+
+			const IMidiMsg msg(ofs, 0x90 | pNoteOn->channel, pNoteOn->key, velocity);
+			ProcessMidiMsg(&msg);
+			break;
+		}
+
+		case CLAP_EVENT_NOTE_OFF:
+		{
+			const clap_event_note* const pNoteOff = (const clap_event_note*)pEvent;
+			if (pNoteOff->port_index != 0) break;
+
+			const int velocity = (int)(pNoteOff->velocity * 127.0 + 0.5);
+
+			const IMidiMsg msg(ofs, 0x80 | pNoteOff->channel, pNoteOff->key, velocity);
+			ProcessMidiMsg(&msg);
+			break;
+		}
+
+		case CLAP_EVENT_PARAM_VALUE:
+		{
+			ProcessParamEvent((const clap_event_param_value*)pEvent);
+			break;
+		}
+
+		case CLAP_EVENT_MIDI:
+		{
+			const clap_event_midi* const pMidiEvent = (const clap_event_midi*)pEvent;
+			if (pMidiEvent->port_index) break;
+
+			IMidiMsg msg(ofs);
+			memcpy(&msg.mStatus, pMidiEvent->data, 3);
+
+			ProcessMidiMsg(&msg);
+			break;
+		}
+
+		case CLAP_EVENT_MIDI_SYSEX:
+		{
+			const clap_event_midi_sysex* const pSysExEvent = (const clap_event_midi_sysex*)pEvent;
+			if (pSysExEvent->port_index) break;
+
+			const ISysEx sysex(ofs, pSysExEvent->buffer, pSysExEvent->size);
+			if (sysex.mSize >= 0) ProcessSysEx(&sysex);
+			break;
 		}
 	}
 }
@@ -383,8 +474,21 @@ void IPlugCLAP::ProcessParamEvent(const clap_event_param_value* const pEvent)
 	OnParamChange(idx);
 }
 
+void IPlugCLAP::AddQueuedParamChanges()
+{
+	// Mutex is already locked.
+	int idx;
+	while (mQueuedParamChanges.Pop(&idx))
+	{
+		mParamChanges.Add((idx << 2) | kParamChangeValue);
+		mPushIt = true;
+	}
+}
+
 void IPlugCLAP::AddParamChange(const int change, const int idx)
 {
+	// Keep changes in order.
+	AddQueuedParamChanges();
 	mPushIt = true;
 
 	const unsigned int packed = (idx << 2) | change;
@@ -395,6 +499,8 @@ void IPlugCLAP::AddParamChange(const int change, const int idx)
 
 void IPlugCLAP::PushOutputEvents(const clap_output_events* const pOutEvents)
 {
+	AddQueuedParamChanges();
+
 	const unsigned int* const pParamChanges = mParamChanges.GetFast();
 	const int nChanges = mParamChanges.GetSize();
 
@@ -536,6 +642,9 @@ bool CLAP_ABI IPlugCLAP::ClapInit(const clap_plugin* const pPlug)
 	const clap_host_params* const pHostParams = (const clap_host_params*)pHost->get_extension(pHost, CLAP_EXT_PARAMS);
 	_this->mRequestFlush = pHostParams ? pHostParams->request_flush : NULL;
 
+	const clap_host_tail* const pHostTail = (const clap_host_tail*)pHost->get_extension(pHost, CLAP_EXT_TAIL);
+	_this->mTailChanged = pHostTail ? pHostTail->changed : NULL;
+
 	_this->HostSpecificInit();
 	_this->OnParamReset();
 
@@ -563,7 +672,7 @@ bool CLAP_ABI IPlugCLAP::ClapActivate(const clap_plugin* const pPlug, const doub
 		reset = true;
 	}
 
-	if (maxBufSize != _this->GetBlockSize() || !(flags & kPlugInitBlockSize))
+	if ((int)maxBufSize != _this->GetBlockSize() || !(flags & kPlugInitBlockSize))
 	{
 		_this->SetBlockSize(maxBufSize);
 		reset = true;
@@ -590,6 +699,7 @@ bool CLAP_ABI IPlugCLAP::ClapStartProcessing(const clap_plugin* const pPlug)
 	{
 		_this->mPlugFlags = flags | kPlugFlagsActive;
 		_this->OnActivate(true);
+		_this->EnableGUIParamQueue(true);
 	}
 
 	_this->mMutex.Leave();
@@ -605,6 +715,8 @@ void CLAP_ABI IPlugCLAP::ClapStopProcessing(const clap_plugin* const pPlug)
 
 	if (flags & kPlugFlagsActive)
 	{
+		_this->EnableGUIParamQueue(false);
+
 		_this->mPlugFlags = flags & ~kPlugFlagsActive;
 		_this->OnActivate(false);
 	}
@@ -627,6 +739,8 @@ clap_process_status CLAP_ABI IPlugCLAP::ClapProcess(const clap_plugin* const pPl
 	IPlugCLAP* const _this = (IPlugCLAP*)pPlug->plugin_data;
 	_this->mMutex.Enter();
 
+	_this->ProcessGUIParamChanges();
+
 	const uint32_t nFrames = pProcess->frames_count;
 	const clap_event_transport* const pTransport = pProcess->transport;
 
@@ -642,17 +756,12 @@ clap_process_status CLAP_ABI IPlugCLAP::ClapProcess(const clap_plugin* const pPl
 		memcpy(_this->mTimeSig, &pTransport->tsig_num, 2 * sizeof(uint16_t));
 	}
 
-	if (_this->mPushIt)
+	if (_this->mPushIt || !_this->mQueuedParamChanges.Empty())
 	{
 		_this->mPushIt = false;
 		_this->PushOutputEvents(pProcess->out_events);
 	}
 
-	const clap_input_events* const pInEvents = pProcess->in_events;
-	const uint32_t nEvents = pInEvents->size(pInEvents);
-
-	if (nEvents) _this->ProcessInputEvents(pInEvents, nEvents, nFrames);
-
 	const void* const* inputs = NULL;
 	void* const* outputs = NULL;
 
@@ -683,21 +792,87 @@ clap_process_status CLAP_ABI IPlugCLAP::ClapProcess(const clap_plugin* const pPl
 	const int nInputs = _this->NInChannels();
 	const int nOutputs = _this->NOutChannels();
 
+	if (pProcess->audio_inputs_count)
+	{
+		_this->SetSilentInputs(SilentChannels(&pProcess->audio_inputs[0], is64bits));
+	}
+
 	if (is64bits)
 	{
 		_this->AttachInputBuffers(0, nInputs, (const double* const*)inputs, nFrames);
 		_this->AttachOutputBuffers(0, nOutputs, (double* const*)outputs);
-		_this->ProcessBuffers((double)0.0, nFrames);
 	}
 	else
 	{
 		_this->AttachInputBuffers(0, nInputs, (const float* const*)inputs, nFrames);
 		_this->AttachOutputBuffers(0, nOutputs, (float* const*)outputs);
-		_this->ProcessBuffers((float)0.0f, nFrames);
+	}
+
+	const clap_input_events* const pInEvents = pProcess->in_events;
+	const uint32_t nEvents = pInEvents->size(pInEvents);
+
+	// Include event handling in process stats.
+	_this->BeginProcessStats();
+	_this->CountProcessEvents(nEvents);
+
+	if (nEvents && _this->mMinSubBlockSize > 0)
+	{
+		_this->ProcessSubBlocks(pInEvents, nEvents, nFrames, is64bits);
+		if (!is64bits) _this->CastOutputBuffers((float)0.0f, nFrames);
+		_this->EndProcessStats(nFrames);
+	}
+	else
+	{
+		if (nEvents) _this->ProcessInputEvents(pInEvents, nEvents, nFrames);
+
+		if (is64bits)
+			_this->ProcessBuffers((double)0.0, nFrames);
+		else
+			_this->ProcessBuffers((float)0.0f, nFrames);
+	}
+
+	clap_process_status status = CLAP_PROCESS_CONTINUE;
+	const bool outputSilent = _this->IsOutputSilent();
+
+	if (outputSilent)
+	{
+		// Sleep until input events or non-silent input.
+		status = CLAP_PROCESS_SLEEP;
+	}
+	else if (_this->IsInputSilent())
+	{
+		status = CLAP_PROCESS_TAIL;
+	}
+
+	if (pProcess->audio_outputs_count)
+	{
+		clap_audio_buffer* const pBuf = &pProcess->audio_outputs[0];
+		const uint32_t nChannels = pBuf->channel_count;
+		pBuf->constant_mask = outputSilent ? (nChannels < 64 ? ((uint64_t)1 << nChannels) - 1 : ~(uint64_t)0) : 0;
 	}
 
 	_this->mMutex.Leave();
-	return CLAP_PROCESS_CONTINUE;
+	return status;
+}
+
+// Channels that are constant 0.
+WDL_UINT64 IPlugCLAP::SilentChannels(const clap_audio_buffer* const pBuf, const bool is64bits)
+{
+	const uint64_t constantMask = pBuf->constant_mask;
+	if (!constantMask) return 0;
+
+	const uint32_t nChannels = pBuf->channel_count < 64 ? pBuf->channel_count : 64;
+	WDL_UINT64 silentMask = 0;
+
+	for (uint32_t i = 0; i < nChannels; ++i)
+	{
+		if (!((constantMask >> i) & 1)) continue;
+
+		const bool silent = is64bits ? pBuf->data64[i][0] == 0.0 : pBuf->data32[i][0] == 0.0f;
+		if (silent) silentMask |= (WDL_UINT64)1 << i;
+	}
+
+	return silentMask;
 }
 
 const void* CLAP_ABI IPlugCLAP::ClapGetExtension(const clap_plugin* const pPlug, const char* const id)
@@ -749,6 +924,16 @@ const void* CLAP_ABI IPlugCLAP::ClapGetExtension(const clap_plugin* const pPlug,
 		return &latency;
 	}
 
+	if (!strcmp(id, CLAP_EXT_TAIL))
+	{
+		static const clap_plugin_tail tail =
+		{
+			ClapTailGet
+		};
+
+		return &tail;
+	}
+
 	if (!strcmp(id, CLAP_EXT_RENDER))
 	{
 		static const clap_plugin_render render =
@@ -788,7 +973,7 @@ const void* CLAP_ABI IPlugCLAP::ClapGetExtension(const clap_plugin* const pPlug,
 	if (!strcmp(id, CLAP_EXT_GUI))
 	{
 		const IPlugCLAP* const _this = (const IPlugCLAP*)pPlug->plugin_data;
-		if (!_this->GetGUI()) return NULL;
+		if (!*sClapWindowAPI || !_this->GetGUI()) return NULL;
 
 		static const clap_plugin_gui gui =
 		{
@@ -874,11 +1059,8 @@ bool CLAP_ABI IPlugCLAP::ClapParamsGetValue(const clap_plugin* const pPlug, cons
 	IPlugCLAP* const _this = (IPlugCLAP*)pPlug->plugin_data;
 	if (!_this->NParams(idx)) return false;
 
-	_this->mMutex.Enter();
-
+	// Wait-free, so don't lock mutex.
 	*pValue = GetParamValue(_this->GetParam(idx));
-
-	_this->mMutex.Leave();
 	return true;
 }
 
@@ -956,13 +1138,15 @@ void CLAP_ABI IPlugCLAP::ClapParamsFlush(const clap_plugin* const pPlug, const c
 	IPlugCLAP* const _this = (IPlugCLAP*)pPlug->plugin_data;
 	_this->mMutex.Enter();
 
+	_this->ProcessGUIParamChanges();
+
 	const uint32_t nEvents = pInEvents->size(pInEvents);
 
 	for (uint32_t i = 0; i < nEvents; ++i)
 	{
 		const clap_event_header* const pEvent = pInEvents->get(pInEvents, i);
 
-		if (pEvent->space_id == CLAP_CORE_EVENT_SPACE_ID && pEvent->type == CLAP_EVENT_PARAM_VALUE)
+		if (IsParamValueEvent(pEvent))
 		{
 			_this->ProcessParamEvent((const clap_event_param_value*)pEvent);
 		}
@@ -972,6 +1156,92 @@ void CLAP_ABI IPlugCLAP::ClapParamsFlush(const clap_plugin* const pPlug, const c
 	_this->mMutex.Leave();
 }
 
+// Define IPLUG_STATE_STREAMING to save/load state through the host's
+// stream in pieces, instead of buffering all of it in mState.
+#ifdef IPLUG_STATE_STREAMING
+
+class ClapStateStream: public ByteChunkStream
+{
+public:
+	ClapStateStream(const clap_istream* const pIn, const clap_ostream* const pOut): mIn(pIn), mOut(pOut) {}
+
+	int Read(void* const pBuf, const int size)
+	{
+		return (int)mIn->read(mIn, pBuf, size);
+	}
+
+	bool Write(const void* const pBuf, const int size)
+	{
+		// Host might write less than requested.
+		for (int n = 0; n < size;)
+		{
+			const int64_t nWritten = mOut->write(mOut, (const char*)pBuf + n, size - n);
+			if (nWritten <= 0) return false;
+			n += (int)nWritten;
+		}
+		return true;
+	}
+
+private:
+	const clap_istream* const mIn;
+	const clap_ostream* const mOut;
+};
+
+bool CLAP_ABI IPlugCLAP::ClapStateSave(const clap_plugin* const pPlug, const clap_ostream* const pStream)
+{
+	IPlugCLAP* const _this = (IPlugCLAP*)pPlug->plugin_data;
+	_this->mMutex.Enter();
+
+	// Serialize in pieces of staging buffer size, instead of buffering all
+	// of the state.
+	ClapStateStream stream(NULL, pStream);
+
+	ByteChunk chunk;
+
+	#ifdef IPLUG_COMPRESS_STATE
+	IChunkCodecStream codec(&stream);
+	chunk.SetStream(&codec);
+	#else
+	chunk.SetStream(&stream);
+	#endif
+
+	bool ok = chunk.Alloc(ByteChunkStream::kDefaultBufSize) == ByteChunkStream::kDefaultBufSize;
+	if (ok) ok = _this->SerializeState(&chunk) && chunk.FlushStream();
+
+	#ifdef IPLUG_COMPRESS_STATE
+	if (ok) ok = codec.Finish();
+	#endif
+
+	_this->mMutex.Leave();
+	return ok;
+}
+
+bool CLAP_ABI IPlugCLAP::ClapStateLoad(const clap_plugin* const pPlug, const clap_istream* const pStream)
+{
+	IPlugCLAP* const _this = (IPlugCLAP*)pPlug->plugin_data;
+	_this->mMutex.Enter();
+
+	ClapStateStream stream(pStream, NULL);
+
+	// Decompresses if compressed, else reads as is.
+	IChunkCodecStream codec(&stream);
+
+	ByteChunk chunk;
+	chunk.SetStream(&codec);
+
+	_this->DrainGUIParamQueue();
+	const int pos = _this->UnserializeState(&chunk, 0);
+	const bool ok = pos >= 0;
+
+	_this->OnParamReset();
+	if (ok) _this->RedrawParamControls();
+
+	_this->mMutex.Leave();
+	return ok;
+}
+
+#else
+
 bool CLAP_ABI IPlugCLAP::ClapStateSave(const clap_plugin* const pPlug, const clap_ostream* const pStream)
 {
 	IPlugCLAP* const _this = (IPlugCLAP*)pPlug->plugin_data;
@@ -985,6 +1255,10 @@ bool CLAP_ABI IPlugCLAP::ClapStateSave(const clap_plugin* const pPlug, const cla
 		pChunk->Clear();
 		ok = _this->SerializeState(pChunk);
 
+		#ifdef IPLUG_COMPRESS_STATE
+		if (ok) ok = IChunkCodec::CompressInPlace(pChunk);
+		#endif
+
 		const void* const pData = pChunk->GetBytes();
 		const int64_t size = pChunk->Size();
 
@@ -1025,7 +1299,9 @@ bool CLAP_ABI IPlugCLAP::ClapStateLoad(const clap_plugin* const pPlug, const cla
 
 	if (ok)
 	{
-		const int pos = _this->UnserializeState(pChunk, 0);
+		ByteChunk temp;
+		_this->DrainGUIParamQueue();
+		const int pos = _this->UnserializeState(IChunkCodec::DecompressIfCompressed(pChunk, &temp), 0);
 		ok = pos >= 0;
 
 		_this->OnParamReset();
@@ -1037,6 +1313,8 @@ bool CLAP_ABI IPlugCLAP::ClapStateLoad(const clap_plugin* const pPlug, const cla
 	return ok;
 }
 
+#endif // IPLUG_STATE_STREAMING
+
 uint32_t CLAP_ABI IPlugCLAP::ClapAudioPortsCount(const clap_plugin* const pPlug, const bool isInput)
 {
 	const IPlugCLAP* const _this = (const IPlugCLAP*)pPlug->plugin_data;
@@ -1082,6 +1360,15 @@ uint32_t CLAP_ABI IPlugCLAP::ClapLatencyGet(const clap_plugin* const pPlug)
 	return latency;
 }
 
+// Also called from audio thread, so don't lock mutex.
+uint32_t CLAP_ABI IPlugCLAP::ClapTailGet(const clap_plugin* const pPlug)
+{
+	const IPlugCLAP* const _this = (const IPlugCLAP*)pPlug->plugin_data;
+	const int tail = _this->GetTailSize();
+
+	return tail >= 0 ? (uint32_t)tail : INT32_MAX;
+}
+
 bool CLAP_ABI IPlugCLAP::ClapRenderSet(const clap_plugin* const pPlug, const clap_plugin_render_mode mode)
 {
 	IPlugCLAP* const _this = (IPlugCLAP*)pPlug->plugin_data;
@@ -1185,7 +1472,7 @@ bool CLAP_ABI IPlugCLAP::ClapGUIGetPreferredAPI(const clap_plugin* /* pPlug */,
 {
 	*pID = sClapWindowAPI;
 	*pIsFloating = false;
-	return true;
+	return !!*sClapWindowAPI;
 }
 
 bool CLAP_ABI IPlugCLAP::ClapGUICreate(const clap_plugin* const pPlug, const char* const id, const bool isFloating)
@@ -57,14 +57,30 @@ public:
 	// Should be called only by the graphics object when it resizes itself.
 	void ResizeGraphics(int w, int h);
 
+	// Sample accurate parameter changes: Splits process block at parameter
+	// changes, and calls ProcessDoubleReplacing() for each sub-block. Changes
+	// less than minFrames after start of sub-block are applied at its start.
+	// Disabled (0) by default.
+	inline void SetMinSubBlockSize(const int minFrames) { mMinSubBlockSize = wdl_max(minFrames, 0); }
+	inline int GetMinSubBlockSize() const { return mMinSubBlockSize; }
+
+	// Also informs host (call from audio thread).
+	void SetTailSize(int samples);
+
 protected:
 	void HostSpecificInit() {}
 
 	bool SendMidiMsg(const IMidiMsg* pMsg);
 	bool SendSysEx(const ISysEx* pSysEx);
 
+	void RequestProcess();
+
+	void InformHostOfQueuedParamChange(int idx, double normalizedValue);
+
 private:
 	void ProcessInputEvents(const clap_input_events* pInEvents, uint32_t nEvents, uint32_t nFrames);
+	void ProcessSubBlocks(const clap_input_events* pInEvents, uint32_t nEvents, uint32_t nFrames, bool is64bits);
+	void ProcessInputEvent(const clap_event_header* pEvent, int ofs);
 	void ProcessParamEvent(const clap_event_param_value* pEvent);
 
 	enum EParamChange
@@ -74,6 +90,7 @@ private:
 		kParamChangeEnd
 	};
 
+	void AddQueuedParamChanges();
 	void AddParamChange(int change, int idx);
 	void PushOutputEvents(const clap_output_events* pOutEvents);
 
@@ -81,8 +98,11 @@ private:
 	static void PushMidiMsgs(const clap_output_events* pOutEvents, const IMidiMsg* pMidiOut, int nMidiMsgs, const unsigned char* pSysExBuf);
 
 	static bool DoesMIDIInOut(const IPlugCLAP* pPlug, bool isInput);
+	static WDL_UINT64 SilentChannels(const clap_audio_buffer* pBuf, bool is64bits);
 
+	#ifndef IPLUG_STATE_STREAMING
 	ByteChunk mState; // Persistent storage if the host asks for plugin state.
+	#endif
 
 	uint32_t mTransportFlags;
 	clap_sectime mSongPos;
@@ -90,8 +110,10 @@ private:
 	uint16_t mTimeSig[2];
 
 	bool mPushIt; // Push it real good.
+	int mMinSubBlockSize;
 
 	WDL_TypedBuf<unsigned int> mParamChanges;
+	ILockFreeQueue<int> mQueuedParamChanges; // Param value changes queued by GUI.
 	WDL_TypedBuf<IMidiMsg> mMidiOut;
 	WDL_HeapBuf mSysExBuf;
 
@@ -100,6 +122,7 @@ private:
 
 	void (*mRequestFlush)(const clap_host* host);
 	bool (*mRequestResize)(const clap_host* host, uint32_t width, uint32_t height);
+	void (*mTailChanged)(const clap_host* host);
 
 	void* mGUIParent;
 	int mGUIWidth, mGUIHeight;
@@ -140,6 +163,8 @@ public:
 
 	static uint32_t CLAP_ABI ClapLatencyGet(const clap_plugin* pPlug);
 
+	static uint32_t CLAP_ABI ClapTailGet(const clap_plugin* pPlug);
+
 	static bool CLAP_ABI ClapRenderHasHardRealtimeRequirement(const clap_plugin* pPlug) { return false; }
 	static bool CLAP_ABI ClapRenderSet(const clap_plugin* pPlug, clap_plugin_render_mode mode);
 
@@ -0,0 +1,797 @@
+#include "IPlugOffline.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "WDL/wdlcstring.h"
+
+IPlugOffline::IPlugOffline(
+	void* /* instanceInfo */,
+	const int nParams,
+	const char* const channelIOStr,
+	const int nPresets,
+	const char* const effectName,
+	const char* const productName,
+	const char* const mfrName,
+	const int vendorVersion,
+	const int uniqueID,
+	const int mfrID,
+	const int latency,
+	const int plugDoes
+):
+IPlugBase(
+	nParams,
+	channelIOStr,
+	nPresets,
+	effectName,
+	productName,
+	mfrName,
+	vendorVersion,
+	uniqueID,
+	mfrID,
+	latency,
+	plugDoes)
+{
+	mNInputs = NInChannels();
+	mNOutputs = NOutChannels();
+
+	SetInputChannelConnections(0, mNInputs, true);
+	SetOutputChannelConnections(0, mNOutputs, true);
+
+	mSamplePos = 0.0;
+	mTempo = 120.0;
+	mTimeSig[0] = mTimeSig[1] = 4;
+
+	mNMidiOut = mNSysExOut = 0;
+
+	mPlugFlags |= kPlugFlagsOffline;
+
+	SetBlockSize(kDefaultBlockSize);
+	SetHost("offline", 0);
+}
+
+bool IPlugOffline::AllocStateChunk(int chunkSize)
+{
+	if (chunkSize < 0) chunkSize = GetParamsChunkSize(0, NParams());
+	return mState.Alloc(chunkSize) == chunkSize;
+}
+
+bool IPlugOffline::AllocBankChunk(const int chunkSize)
+{
+	if (chunkSize < 0 && mPresetChunkSize < 0) AllocPresetChunk();
+	return true;
+}
+
+void IPlugOffline::GetTimeSig(int* const pNum, int* const pDenom)
+{
+	*pNum = mTimeSig[0];
+	*pDenom = mTimeSig[1];
+}
+
+bool IPlugOffline::SendMidiMsg(const IMidiMsg* /* pMsg */)
+{
+	mNMidiOut++;
+	return true;
+}
+
+bool IPlugOffline::SendSysEx(const ISysEx* /* pSysEx */)
+{
+	mNSysExOut++;
+	return true;
+}
+
+static bool ReadFile(const char* const fn, WDL_HeapBuf* const pBuf)
+{
+	FILE* const fp = fopen(fn, "rb");
+	if (!fp) return false;
+
+	fseek(fp, 0, SEEK_END);
+	const long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	bool ok = size >= 0 && pBuf->ResizeOK((int)size, false);
+	if (ok) ok = fread(pBuf->Get(), 1, size, fp) == (size_t)size;
+
+	fclose(fp);
+	return ok;
+}
+
+static inline unsigned int GetLE(const unsigned char* const p, const int nBytes)
+{
+	unsigned int x = 0;
+	for (int i = nBytes - 1; i >= 0; --i) x = (x << 8) | p[i];
+	return x;
+}
+
+static inline unsigned int GetBE(const unsigned char* const p, const int nBytes)
+{
+	unsigned int x = 0;
+	for (int i = 0; i < nBytes; ++i) x = (x << 8) | p[i];
+	return x;
+}
+
+static inline void PutLE(unsigned char* const p, unsigned int x, const int nBytes)
+{
+	for (int i = 0; i < nBytes; ++i, x >>= 8) p[i] = (unsigned char)x;
+}
+
+// Reads PCM (8/16/24/32-bit) or float (32/64-bit) WAV file into
+// deinterleaved channel buffers. Returns number of frames, or -1 on error.
+static int ReadWAV(const char* const fn, WDL_TypedBuf<double>* const pBuf, int* const pNChannels, double* const pSampleRate)
+{
+	WDL_HeapBuf file;
+	if (!ReadFile(fn, &file)) return -1;
+
+	const unsigned char* p = (const unsigned char*)file.Get();
+	const unsigned char* const pEnd = p + file.GetSize();
+
+	if (pEnd - p < 12 || memcmp(p, "RIFF", 4) || memcmp(p + 8, "WAVE", 4)) return -1;
+	p += 12;
+
+	int format = 0, nChannels = 0, bits = 0;
+	const unsigned char* pData = NULL;
+	unsigned int dataSize = 0;
+
+	while (pEnd - p >= 8)
+	{
+		const unsigned int size = GetLE(p + 4, 4);
+		const unsigned char* const pChunk = p + 8;
+		if ((unsigned int)(pEnd - pChunk) < size) break;
+
+		if (!memcmp(p, "fmt ", 4) && size >= 16)
+		{
+			format = GetLE(pChunk, 2);
+			nChannels = GetLE(pChunk + 2, 2);
+			*pSampleRate = (double)GetLE(pChunk + 4, 4);
+			bits = GetLE(pChunk + 14, 2);
+
+			// WAVE_FORMAT_EXTENSIBLE, format is in first 2 bytes of GUID.
+			if (format == 0xFFFE && size >= 26) format = GetLE(pChunk + 24, 2);
+		}
+		else if (!memcmp(p, "data", 4))
+		{
+			pData = pChunk;
+			dataSize = size;
+		}
+
+		p = pChunk + size + (size & 1);
+	}
+
+	const bool isFloat = format == 3 && (bits == 32 || bits == 64);
+	if (!pData || nChannels <= 0 || !(isFloat || (format == 1 && bits >= 8 && bits <= 32 && !(bits & 7)))) return -1;
+
+	const int bytesPerSample = bits / 8;
+	const int nFrames = (int)(dataSize / (nChannels * bytesPerSample));
+
+	double* const pDest = pBuf->ResizeOK(nChannels * nFrames, false);
+	if (!pDest) return -1;
+
+	const double scale = isFloat ? 1.0 : 1.0 / (double)(1u << (bits - 1));
+
+	for (int i = 0; i < nFrames; ++i)
+	{
+		for (int ch = 0; ch < nChannels; ++ch, pData += bytesPerSample)
+		{
+			double x;
+			if (bits == 64)
+			{
+				WDL_UINT64 u = (WDL_UINT64)GetLE(pData + 4, 4) << 32 | GetLE(pData, 4);
+				memcpy(&x, &u, sizeof(double));
+			}
+			else if (isFloat)
+			{
+				const unsigned int u = GetLE(pData, 4);
+				float f;
+				memcpy(&f, &u, sizeof(float));
+				x = (double)f;
+			}
+			else if (bits == 8)
+			{
+				x = (double)((int)*pData - 128);
+			}
+			else
+			{
+				// Sign extend.
+				const int shift = 32 - bits;
+				x = (double)((int)(GetLE(pData, bytesPerSample) << shift) >> shift);
+			}
+			pDest[ch * nFrames + i] = x * scale;
+		}
+	}
+
+	*pNChannels = nChannels;
+	return nFrames;
+}
+
+// Writes 32-bit float WAV file.
+static bool WriteWAV(const char* const fn, const double* const* const ppData, const int nChannels, const int nFrames, const double sampleRate)
+{
+	FILE* const fp = fopen(fn, "wb");
+	if (!fp) return false;
+
+	const unsigned int dataSize = nChannels * nFrames * 4;
+
+	unsigned char hdr[44];
+	memcpy(hdr, "RIFF", 4);
+	PutLE(hdr + 4, 36 + dataSize, 4);
+	memcpy(hdr + 8, "WAVEfmt ", 8);
+	PutLE(hdr + 16, 16, 4);
+	PutLE(hdr + 20, 3, 2); // WAVE_FORMAT_IEEE_FLOAT
+	PutLE(hdr + 22, nChannels, 2);
+	PutLE(hdr + 24, (unsigned int)sampleRate, 4);
+	PutLE(hdr + 28, (unsigned int)sampleRate * nChannels * 4, 4);
+	PutLE(hdr + 32, nChannels * 4, 2);
+	PutLE(hdr + 34, 32, 2);
+	memcpy(hdr + 36, "data", 4);
+	PutLE(hdr + 40, dataSize, 4);
+
+	bool ok = fwrite(hdr, 1, sizeof(hdr), fp) == sizeof(hdr);
+
+	unsigned char buf[4 * 256];
+	for (int i = 0; i < nFrames && ok; )
+	{
+		int n = 0;
+		for (; i < nFrames && n + nChannels * 4 <= (int)sizeof(buf); ++i)
+		{
+			for (int ch = 0; ch < nChannels; ++ch, n += 4)
+			{
+				const float f = (float)ppData[ch][i];
+				unsigned int u;
+				memcpy(&u, &f, sizeof(float));
+				PutLE(buf + n, u, 4);
+			}
+		}
+		ok = fwrite(buf, 1, n, fp) == (size_t)n;
+	}
+
+	return !fclose(fp) && ok;
+}
+
+static int ReadVarLen(const unsigned char** const pp, const unsigned char* const pEnd)
+{
+	const unsigned char* p = *pp;
+	int x = 0;
+
+	for (int i = 0; i < 4 && p < pEnd; ++i)
+	{
+		const int c = *p++;
+		x = (x << 7) | (c & 0x7F);
+		if (!(c & 0x80)) break;
+	}
+
+	*pp = p;
+	return x;
+}
+
+struct SMFEvent
+{
+	WDL_INT64 mTick;
+	int mSeq, mTempo; // Tempo is microseconds per quarter note, or 0 for MIDI message.
+	IMidiMsg mMsg;
+};
+
+static int SortSMFEvents(const void* const a, const void* const b)
+{
+	const SMFEvent* const pA = (const SMFEvent*)a;
+	const SMFEvent* const pB = (const SMFEvent*)b;
+
+	if (pA->mTick != pB->mTick) return pA->mTick < pB->mTick ? -1 : 1;
+
+	// Tempo changes before MIDI messages at same tick.
+	if (!pA->mTempo != !pB->mTempo) return pA->mTempo ? -1 : 1;
+
+	return pA->mSeq - pB->mSeq;
+}
+
+// Reads Standard MIDI File (format 0 or 1), and converts channel messages
+// to sample positions using tempo map. SysEx is ignored. Returns initial
+// tempo, or 0 on error.
+static double ReadMIDIFile(const char* const fn, const double sampleRate, WDL_TypedBuf<IMidiMsg>* const pMsgs, WDL_TypedBuf<WDL_INT64>* const pPos)
+{
+	WDL_HeapBuf file;
+	if (!ReadFile(fn, &file)) return 0.0;
+
+	const unsigned char* p = (const unsigned char*)file.Get();
+	const unsigned char* const pEnd = p + file.GetSize();
+
+	if (pEnd - p < 14 || memcmp(p, "MThd", 4) || GetBE(p + 4, 4) < 6) return 0.0;
+
+	const int nTracks = GetBE(p + 10, 2);
+	const int division = GetBE(p + 12, 2);
+	p += 8 + GetBE(p + 4, 4);
+
+	WDL_TypedBuf<SMFEvent> events;
+	int seq = 0;
+
+	for (int track = 0; track < nTracks && pEnd - p >= 8; ++track)
+	{
+		if (memcmp(p, "MTrk", 4)) return 0.0;
+
+		const unsigned int size = GetBE(p + 4, 4);
+		p += 8;
+
+		const unsigned char* const pTrackEnd = (unsigned int)(pEnd - p) < size ? pEnd : p + size;
+
+		WDL_INT64 tick = 0;
+		int status = 0;
+
+		while (p < pTrackEnd)
+		{
+			tick += ReadVarLen(&p, pTrackEnd);
+			if (p >= pTrackEnd) break;
+
+			if (*p & 0x80) status = *p++;
+
+			if (status == 0xFF)
+			{
+				if (p >= pTrackEnd) break;
+				const int type = *p++;
+				const int len = ReadVarLen(&p, pTrackEnd);
+				if (len > pTrackEnd - p) break;
+
+				if (type == 0x51 && len == 3)
+				{
+					SMFEvent event;
+					event.mTick = tick;
+					event.mSeq = seq++;
+					event.mTempo = GetBE(p, 3);
+					if (event.mTempo) events.Add(event);
+				}
+				p += len;
+				status = 0;
+			}
+			else if (status == 0xF0 || status == 0xF7)
+			{
+				const int len = ReadVarLen(&p, pTrackEnd);
+				if (len > pTrackEnd - p) break;
+				p += len;
+				status = 0;
+			}
+			else if (status >= 0x80 && status < 0xF0)
+			{
+				const int hi = status >> 4;
+				const int nData = hi == IMidiMsg::kProgramChange || hi == IMidiMsg::kChannelAftertouch ? 1 : 2;
+				if (nData > pTrackEnd - p) break;
+
+				SMFEvent event;
+				event.mTick = tick;
+				event.mSeq = seq++;
+				event.mTempo = 0;
+
+				event.mMsg = IMidiMsg();
+				event.mMsg.mStatus = (unsigned char)status;
+				event.mMsg.mData1 = p[0];
+				event.mMsg.mData2 = nData > 1 ? p[1] : 0;
+				p += nData;
+
+				events.Add(event);
+			}
+			else
+			{
+				// Data byte without running status.
+				break;
+			}
+		}
+
+		p = pTrackEnd;
+	}
+
+	const int nEvents = events.GetSize();
+	SMFEvent* const pEvents = events.Get();
+	qsort(pEvents, nEvents, sizeof(SMFEvent), SortSMFEvents);
+
+	// SMPTE division (negative frames per second, ticks per frame).
+	const bool smpte = !!(division & 0x8000);
+	const double ticksPerSec = smpte ? (double)(-(signed char)(division >> 8) * (division & 0xFF)) : 0.0;
+	const int ppq = smpte ? 0 : division;
+	if (smpte ? ticksPerSec <= 0.0 : ppq <= 0) return 0.0;
+
+	double tempo = 500000.0, firstTempo = 0.0;
+	double sec = 0.0;
+	WDL_INT64 lastTick = 0;
+
+	for (int i = 0; i < nEvents; ++i)
+	{
+		const SMFEvent* const pEvent = &pEvents[i];
+
+		const double secPerTick = smpte ? 1.0 / ticksPerSec : tempo * 1.0e-6 / (double)ppq;
+		sec += (double)(pEvent->mTick - lastTick) * secPerTick;
+		lastTick = pEvent->mTick;
+
+		if (pEvent->mTempo)
+		{
+			tempo = (double)pEvent->mTempo;
+			if (!pEvent->mTick && firstTempo == 0.0) firstTempo = tempo;
+		}
+		else
+		{
+			pMsgs->Add(pEvent->mMsg);
+			pPos->Add((WDL_INT64)(sec * sampleRate + 0.5));
+		}
+	}
+
+	return 60.0e6 / (firstTempo != 0.0 ? firstTempo : 500000.0);
+}
+
+static double GetTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int SortDoubles(const void* const a, const void* const b)
+{
+	const double x = *(const double*)a, y = *(const double*)b;
+	return x < y ? -1 : x > y;
+}
+
+static void PrintUsage(const char* const exe)
+{
+	printf(
+		"Usage: %s [options]\n"
+		"\n"
+		"  -i <file.wav>   Input WAV file (default is generated signal)\n"
+		"  -gen <signal>   Generate sine, noise, impulse, or silence (default sine)\n"
+		"  -freq <Hz>      Sine frequency (default 440)\n"
+		"  -len <seconds>  Length of generated signal (default 10)\n"
+		"  -m <file.mid>   Send MIDI file to ProcessMidiMsg()\n"
+		"  -o <file.wav>   Write output to 32-bit float WAV file\n"
+		"  -sr <Hz>        Sample rate (default WAV sample rate, or 44100)\n"
+		"  -bs <frames>    Block size (default 1024)\n"
+		"  -io <in>-<out>  Connected channels (default all)\n"
+		"  -tempo <BPM>    Tempo (default MIDI file tempo, or 120)\n"
+		"  -float          Process 32-bit float buffers (default 64-bit)\n",
+		WDL_get_filepart(exe));
+}
+
+int IPlugOffline::Run(const int argc, const char* const* const argv)
+{
+	const char *inFn = NULL, *outFn = NULL, *midiFn = NULL, *gen = "sine";
+	double freq = 440.0, len = 10.0, sampleRate = 0.0, tempo = 0.0;
+	int blockSize = kDefaultBlockSize;
+	int nIn = NInChannels(), nOut = NOutChannels();
+	bool is64bits = true;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* const opt = argv[i];
+		const char* const arg = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (!strcmp(opt, "-float"))
+		{
+			is64bits = false;
+			continue;
+		}
+
+		if (!arg || *opt != '-')
+		{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+		++i;
+
+		if (!strcmp(opt, "-i")) inFn = arg;
+		else if (!strcmp(opt, "-o")) outFn = arg;
+		else if (!strcmp(opt, "-m")) midiFn = arg;
+		else if (!strcmp(opt, "-gen")) gen = arg;
+		else if (!strcmp(opt, "-freq")) freq = atof(arg);
+		else if (!strcmp(opt, "-len")) len = atof(arg);
+		else if (!strcmp(opt, "-sr")) sampleRate = atof(arg);
+		else if (!strcmp(opt, "-bs")) blockSize = atoi(arg);
+		else if (!strcmp(opt, "-tempo")) tempo = atof(arg);
+		else if (!strcmp(opt, "-io") && sscanf(arg, "%d-%d", &nIn, &nOut) == 2) {}
+		else
+		{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (argc <= 1)
+	{
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	if (nIn < 0 || nIn > NInChannels() || nOut < 0 || nOut > NOutChannels() || !LegalIO(nIn, nOut))
+	{
+		fprintf(stderr, "Unsupported channel I/O %d-%d\n", nIn, nOut);
+		return 1;
+	}
+
+	if (blockSize <= 0 || len < 0.0)
+	{
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	// Input signal.
+
+	WDL_TypedBuf<double> inBuf;
+	int nFrames = 0, nWAVChannels = 0;
+
+	if (inFn)
+	{
+		double wavRate = 0.0;
+		nFrames = ReadWAV(inFn, &inBuf, &nWAVChannels, &wavRate);
+
+		if (nFrames < 0)
+		{
+			fprintf(stderr, "Could not read %s\n", inFn);
+			return 1;
+		}
+
+		if (sampleRate <= 0.0) sampleRate = wavRate;
+	}
+
+	if (sampleRate <= 0.0) sampleRate = (double)kDefaultSampleRate;
+
+	// MIDI events.
+
+	mMidiIn.Resize(0);
+
+	if (midiFn)
+	{
+		WDL_TypedBuf<IMidiMsg> msgs;
+		WDL_TypedBuf<WDL_INT64> pos;
+
+		const double midiTempo = ReadMIDIFile(midiFn, sampleRate, &msgs, &pos);
+		if (midiTempo == 0.0)
+		{
+			fprintf(stderr, "Could not read %s\n", midiFn);
+			return 1;
+		}
+
+		if (tempo <= 0.0) tempo = midiTempo;
+
+		const int n = msgs.GetSize();
+		MidiEvent* const pEvents = mMidiIn.ResizeOK(n, false);
+		if (!pEvents) return 1;
+
+		for (int i = 0; i < n; ++i)
+		{
+			pEvents[i].mPos = pos.Get()[i];
+			pEvents[i].mMsg = msgs.Get()[i];
+		}
+
+		// Keep rendering for a bit after last MIDI event (i.e. release).
+		if (!inFn && n)
+		{
+			len = wdl_max(len, (double)pos.Get()[n - 1] / sampleRate + 2.0);
+		}
+	}
+
+	if (tempo > 0.0) mTempo = tempo;
+
+	if (!inFn)
+	{
+		nFrames = (int)(len * sampleRate + 0.5);
+		nWAVChannels = 1;
+
+		double* const pDest = inBuf.ResizeOK(nFrames, false);
+		if (!pDest && nFrames) return 1;
+
+		if (!strcmp(gen, "sine"))
+		{
+			const double w = 2.0 * 3.14159265358979323846 * freq / sampleRate;
+			for (int i = 0; i < nFrames; ++i) pDest[i] = 0.5 * sin(w * (double)i);
+		}
+		else if (!strcmp(gen, "noise"))
+		{
+			// Deterministic, so renders are reproducible.
+			unsigned int seed = 1;
+			for (int i = 0; i < nFrames; ++i)
+			{
+				seed = seed * 1664525 + 1013904223;
+				pDest[i] = (double)(int)seed * (0.5 / 2147483648.0);
+			}
+		}
+		else if (!strcmp(gen, "impulse") || !strcmp(gen, "silence"))
+		{
+			memset(pDest, 0, nFrames * sizeof(double));
+			if (nFrames && *gen == 'i') pDest[0] = 1.0;
+		}
+		else
+		{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	// Channel buffers, repeating input channels if file has fewer.
+
+	WDL_TypedBuf<const double*> inPtrs;
+	WDL_TypedBuf<double*> outPtrs;
+	WDL_TypedBuf<double> outBuf;
+
+	const double** const ppIn = inPtrs.ResizeOK(nIn, false);
+	double** const ppOut = outPtrs.ResizeOK(nOut, false);
+	double* const pOut = outBuf.ResizeOK(nOut * nFrames, false);
+
+	if ((!ppIn && nIn) || (!ppOut && nOut) || (!pOut && nOut && nFrames)) return 1;
+
+	for (int ch = 0; ch < nIn; ++ch) ppIn[ch] = inBuf.Get() + (ch % nWAVChannels) * nFrames;
+	for (int ch = 0; ch < nOut; ++ch) ppOut[ch] = pOut + ch * nFrames;
+
+	mNInputs = nIn;
+	mNOutputs = nOut;
+
+	SetInputChannelConnections(0, nIn, true);
+	SetInputChannelConnections(nIn, NInChannels() - nIn, false);
+	SetOutputChannelConnections(0, nOut, true);
+	SetOutputChannelConnections(nOut, NOutChannels() - nOut, false);
+
+	// Activate.
+
+	mMutex.Enter();
+
+	SetSampleRate(sampleRate);
+	SetBlockSize(blockSize);
+	mPlugFlags |= kPlugInit;
+	Reset();
+
+	mPlugFlags |= kPlugFlagsActive;
+	OnActivate(true);
+	EnableGUIParamQueue(true);
+
+	mMutex.Leave();
+
+	// Render.
+
+	mNMidiOut = mNSysExOut = 0;
+
+	const clock_t cpuStart = clock();
+	const double wallStart = GetTime();
+
+	const bool ok = Render(ppIn, ppOut, nFrames, is64bits);
+
+	const double wallTime = GetTime() - wallStart;
+	const double cpuTime = (double)(clock() - cpuStart) / (double)CLOCKS_PER_SEC;
+
+	// Deactivate.
+
+	mMutex.Enter();
+
+	EnableGUIParamQueue(false);
+	mPlugFlags &= ~kPlugFlagsActive;
+	OnActivate(false);
+
+	mMutex.Leave();
+
+	if (!ok) return 1;
+
+	// Report.
+
+	const double duration = (double)nFrames / sampleRate;
+	const int nBlocks = mBlockTime.GetSize();
+	double* const pTime = mBlockTime.Get();
+
+	const double budget = (double)blockSize / sampleRate;
+	int nOver = 0;
+	for (int i = 0; i < nBlocks; ++i) nOver += pTime[i] > budget;
+
+	qsort(pTime, nBlocks, sizeof(double), SortDoubles);
+
+	#define PERCENTILE(p) (nBlocks ? 1.0e6 * pTime[(int)((double)(p) * (nBlocks - 1) + 0.5)] : 0.0)
+
+	printf("%s: %d frames (%.3f s), %.0f Hz, %d-%d channels, %d-bit, block size %d\n",
+		mEffectName.Get(), nFrames, duration, sampleRate, nIn, nOut, is64bits ? 64 : 32, blockSize);
+
+	if (midiFn)
+	{
+		printf("MIDI: %d messages in, %d messages out, %d SysEx out\n", mMidiIn.GetSize(), mNMidiOut, mNSysExOut);
+	}
+
+	printf("Wall time %.3f ms, CPU time %.3f ms, realtime factor %.1fx\n",
+		1.0e3 * wallTime, 1.0e3 * cpuTime, wallTime > 0.0 ? duration / wallTime : 0.0);
+
+	printf("Block time (us): p50 %.1f, p90 %.1f, p99 %.1f, max %.1f; budget %.1f, %d of %d blocks over\n",
+		PERCENTILE(0.50), PERCENTILE(0.90), PERCENTILE(0.99), PERCENTILE(1.0), 1.0e6 * budget, nOver, nBlocks);
+
+	#undef PERCENTILE
+
+	if (outFn && !WriteWAV(outFn, ppOut, nOut, nFrames, sampleRate))
+	{
+		fprintf(stderr, "Could not write %s\n", outFn);
+		return 1;
+	}
+
+	return 0;
+}
+
+// Converts to float if needed, then processes all blocks.
+bool IPlugOffline::Render(const double* const* const ppIn, double* const* const ppOut, const int nFrames, const bool is64bits)
+{
+	const int nIn = mNInputs, nOut = mNOutputs;
+	const int nBlocks = (nFrames + GetBlockSize() - 1) / GetBlockSize();
+
+	if (!mBlockTime.ResizeOK(nBlocks, false) && nBlocks) return false;
+
+	if (is64bits)
+	{
+		ProcessBlocks(ppIn, ppOut, nFrames);
+		return true;
+	}
+
+	WDL_TypedBuf<float> buf;
+	WDL_TypedBuf<const float*> inPtrs;
+	WDL_TypedBuf<float*> outPtrs;
+
+	float* const pBuf = buf.ResizeOK((nIn + nOut) * nFrames, false);
+	const float** const ppInF = inPtrs.ResizeOK(nIn, false);
+	float** const ppOutF = outPtrs.ResizeOK(nOut, false);
+
+	if ((!pBuf && nFrames) || (!ppInF && nIn) || (!ppOutF && nOut)) return false;
+
+	for (int ch = 0; ch < nIn; ++ch)
+	{
+		float* const pDest = pBuf + ch * nFrames;
+		for (int i = 0; i < nFrames; ++i) pDest[i] = (float)ppIn[ch][i];
+		ppInF[ch] = pDest;
+	}
+
+	for (int ch = 0; ch < nOut; ++ch) ppOutF[ch] = pBuf + (nIn + ch) * nFrames;
+
+	ProcessBlocks(ppInF, ppOutF, nFrames);
+
+	for (int ch = 0; ch < nOut; ++ch)
+	{
+		for (int i = 0; i < nFrames; ++i) ppOut[ch][i] = (double)ppOutF[ch][i];
+	}
+
+	return true;
+}
+
+// Same sequence as a wrapper process call: Apply GUI param changes, send
+// MIDI, attach buffers, and process, all with mutex locked.
+template <class SAMPLETYPE> void IPlugOffline::ProcessBlocks(const SAMPLETYPE* const* const ppIn, SAMPLETYPE* const* const ppOut, const int nFrames)
+{
+	const int nIn = mNInputs, nOut = mNOutputs;
+	const int blockSize = GetBlockSize();
+
+	WDL_TypedBuf<const SAMPLETYPE*> inPtrs;
+	WDL_TypedBuf<SAMPLETYPE*> outPtrs;
+
+	const SAMPLETYPE** const ppBlockIn = inPtrs.Resize(nIn, false);
+	SAMPLETYPE** const ppBlockOut = outPtrs.Resize(nOut, false);
+
+	const MidiEvent* pEvent = mMidiIn.Get();
+	const MidiEvent* const pEventEnd = pEvent + mMidiIn.GetSize();
+
+	double* const pTime = mBlockTime.Get();
+
+	for (int pos = 0, block = 0; pos < nFrames; pos += blockSize, ++block)
+	{
+		const int n = wdl_min(blockSize, nFrames - pos);
+
+		for (int ch = 0; ch < nIn; ++ch) ppBlockIn[ch] = ppIn[ch] + pos;
+		for (int ch = 0; ch < nOut; ++ch) ppBlockOut[ch] = ppOut[ch] + pos;
+
+		const double start = GetTime();
+		mMutex.Enter();
+
+		// Include MIDI handling in process stats.
+		BeginProcessStats();
+
+		ProcessGUIParamChanges();
+		mSamplePos = (double)pos;
+
+		for (; pEvent < pEventEnd && pEvent->mPos < pos + n; ++pEvent)
+		{
+			IMidiMsg msg = pEvent->mMsg;
+			msg.mOffset = (int)wdl_max(pEvent->mPos - pos, 0);
+			CountProcessEvents(1);
+			ProcessMidiMsg(&msg);
+		}
+
+		AttachInputBuffers(0, NInChannels(), ppBlockIn, n);
+		AttachOutputBuffers(0, NOutChannels(), ppBlockOut);
+		ProcessBuffers((SAMPLETYPE)0, n);
+
+		mMutex.Leave();
+		pTime[block] = GetTime() - start;
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+// Offline render "host" that builds the plugin into a command line
+// executable, which feeds a WAV file or generated signal (and optionally a
+// MIDI file) through the plugin, and reports processing speed. Uses the
+// same AttachInputBuffers()/ProcessBuffers() path as the real wrappers.
+
+#include "IPlugBase.h"
+
+#include "WDL/heapbuf.h"
+#include "WDL/wdltypes.h"
+
+class IPlugOffline: public IPlugBase
+{
+public:
+	// Use IPLUG_CTOR instead of calling directly (defined in IPlug_include_in_plug_hdr.h).
+	IPlugOffline(
+		void* instanceInfo,
+		int nParams,
+		const char* channelIOStr,
+		int nPresets,
+		const char* effectName,
+		const char* productName,
+		const char* mfrName,
+		int vendorVersion,
+		int uniqueID,
+		int mfrID,
+		int latency,
+		int plugDoes
+	);
+
+	// ----------------------------------------
+	// See IPlugBase for the full list of methods that your plugin class can implement.
+
+	// Default implementation to mimic original IPlug VST2 behavior.
+	void OnActivate(const bool active) { if (!active) Reset(); }
+
+	bool AllocStateChunk(int chunkSize = -1);
+	bool AllocBankChunk(int chunkSize = -1);
+
+	void SetPresetName(int idx, const char* name) {}
+
+	void BeginInformHostOfParamChange(int idx, bool lockMutex = true) {}
+	void InformHostOfParamChange(int idx, double normalizedValue, bool lockMutex = true) {}
+	void EndInformHostOfParamChange(int idx, bool lockMutex = true) {}
+
+	void InformHostOfProgramChange() {}
+
+	double GetSamplePos() { return mSamplePos; } // Samples since start of render.
+	double GetTempo() { return mTempo; }
+	void GetTimeSig(int* pNum, int* pDenom);
+
+	// Always offline.
+	bool IsRenderingOffline() { return true; }
+
+	void ResizeGraphics(int w, int h) {}
+
+	// Parses command line, renders, and prints stats to stdout. Returns 0
+	// on success (use as exit code). Run without arguments for usage.
+	int Run(int argc, const char* const* argv);
+
+protected:
+	void HostSpecificInit() {}
+
+	bool SendMidiMsg(const IMidiMsg* pMsg);
+	bool SendSysEx(const ISysEx* pSysEx);
+
+private:
+	struct MidiEvent
+	{
+		WDL_INT64 mPos; // Sample position.
+		IMidiMsg mMsg;
+	};
+
+	bool Render(const double* const* ppIn, double* const* ppOut, int nFrames, bool is64bits);
+
+	template <class SAMPLETYPE> void ProcessBlocks(const SAMPLETYPE* const* ppIn, SAMPLETYPE* const* ppOut, int nFrames);
+
+	ByteChunk mState; // Persistent storage if the host asks for plugin state.
+
+	double WDL_FIXALIGN mSamplePos, mTempo;
+	int mTimeSig[2];
+
+	int mNInputs, mNOutputs;
+
+	WDL_TypedBuf<MidiEvent> mMidiIn;
+	int mNMidiOut, mNSysExOut;
+
+	WDL_TypedBuf<double> mBlockTime; // Per-block time (seconds).
+}
+WDL_FIXALIGN;
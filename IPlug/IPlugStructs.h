@@ -137,7 +137,7 @@ struct IRECT
 	int L, T, R, B;
 
 	inline IRECT() { Clear(); }
-	IRECT(const int l, const int t, const int r, const int b): L(l), R(r), T(t), B(b) {}
+	IRECT(const int l, const int t, const int r, const int b): L(l), T(t), R(r), B(b) {}
 	IRECT(const int x, const int y, const IBitmap* const pBitmap): L(x), T(y), R(x + pBitmap->W), B(y + pBitmap->H) {}
 
 	bool Empty() const
@@ -424,7 +424,7 @@ struct ISysEx
 	const void* mData;
 
 	ISysEx(const int offs = 0, const void* const pData = NULL, const int size = 0)
-	: mOffset(offs), mData(pData), mSize(size) {}
+	: mOffset(offs), mSize(size), mData(pData) {}
 
 	void Clear()
 	{
@@ -1,6 +1,7 @@
 #include "IPlugVST2.h"
 #include "IGraphics.h"
 #include "Hosts.h"
+#include "IChunkCodec.h"
 
 #ifdef __APPLE__
 	#include "IGraphicsMac.h"
@@ -560,8 +561,10 @@ VstIntPtr VSTCALLBACK IPlugVST2::VSTDispatcher(AEffect* const pEffect, const Vst
 			const bool active = !!value;
 			if (_this->IsActive() != active)
 			{
+				if (!active) _this->EnableGUIParamQueue(false);
 				_this->mPlugFlags ^= IPlugBase::kPlugFlagsActive;
 				_this->OnActivate(active);
+				if (active) _this->EnableGUIParamQueue(true);
 			}
 			break;
 		}
@@ -651,6 +654,9 @@ VstIntPtr VSTCALLBACK IPlugVST2::VSTDispatcher(AEffect* const pEffect, const Vst
 				{
 					savedOK = _this->SerializeState(pChunk);
 				}
+				#ifdef IPLUG_COMPRESS_STATE
+				if (savedOK) savedOK = IChunkCodec::CompressInPlace(pChunk);
+				#endif
 				void* const pData = pChunk->GetBytes();
 				const int size = pChunk->Size();
 				if (savedOK && size)
@@ -667,16 +673,18 @@ VstIntPtr VSTCALLBACK IPlugVST2::VSTDispatcher(AEffect* const pEffect, const Vst
 			if (ptr)
 			{
 				const bool isBank = !idx;
-				ByteChunk* const pChunk = isBank ? &_this->mBankState : &_this->mState;
 				const int size = (int)value;
-				if (pChunk->Size() != size)
-				{
-					pChunk->Resize(size);
-					if (pChunk->Size() != size) break;
-				}
-				memcpy(pChunk->GetBytes(), ptr, size);
+				if (size < 0) break;
+
+				// Read directly from host memory (unless compressed).
+				const ByteChunkView chunk(ptr, size);
+				ByteChunk temp;
+				const ByteChunk* const pChunk = IChunkCodec::DecompressIfCompressed(&chunk, &temp);
+
 				int pos = 0;
 				const int iplugVer = GetIPlugVerFromChunk(pChunk, &pos);
+
+				_this->DrainGUIParamQueue();
 				if (isBank & (iplugVer >= 0x010000))
 				{
 					pos = _this->UnserializeBank(pChunk, pos);
@@ -705,6 +713,8 @@ VstIntPtr VSTCALLBACK IPlugVST2::VSTDispatcher(AEffect* const pEffect, const Vst
 			const int numEvents = pEvents->numEvents;
 			if (pEvents->events)
 			{
+				_this->CountProcessEvents(numEvents);
+
 				for (int i = 0; i < numEvents; ++i)
 				{
 					const VstEvent* const pEvent = pEvents->events[i];
@@ -884,6 +894,14 @@ VstIntPtr VSTCALLBACK IPlugVST2::VSTDispatcher(AEffect* const pEffect, const Vst
 			break;
 		}
 
+		case effGetTailSize:
+		{
+			// 0 = default (unknown), 1 = no tail.
+			const int tail = _this->GetTailSize();
+			ret = tail > 0 ? tail : !tail;
+			break;
+		}
+
 		case effGetParameterProperties:
 		{
 			if (ptr && _this->NParams(idx))
@@ -1134,6 +1152,8 @@ VstIntPtr IPlugVST2::VSTPlugCanDo(const char* const ptr)
 template <class SAMPLETYPE>
 void IPlugVST2::VSTPrepProcess(const SAMPLETYPE* const* const inputs, SAMPLETYPE* const* const outputs, const VstInt32 nFrames)
 {
+	ProcessGUIParamChanges();
+
 	if (DoesMIDI())
 	{
 		mHostCallback(&mAEffect, DECLARE_VST_DEPRECATED(audioMasterWantMidi), 0, 0, NULL, 0.0f);
@@ -1180,12 +1200,10 @@ float VSTCALLBACK IPlugVST2::VSTGetParameter(AEffect* const pEffect, const VstIn
 {
 	double v = 0.0;
 
+	// Wait-free, so don't lock mutex.
 	IPlugVST2* const _this = (IPlugVST2*)pEffect->object;
-	_this->mMutex.Enter();
+	if (_this->NParams(idx)) v = _this->GetParam(idx)->GetAtomicNormalized();
 
-	if (_this->NParams(idx)) v = _this->GetParam(idx)->GetNormalized();
-
-	_this->mMutex.Leave();
 	return (float)v;
 }
 
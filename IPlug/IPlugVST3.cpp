@@ -1,6 +1,7 @@
 #include "IPlugVST3.h"
 #include "IGraphics.h"
 #include "IControl.h"
+#include "IChunkCodec.h"
 
 #include "VST3_SDK/base/source/fstreamer.h"
 #include "VST3_SDK/pluginterfaces/base/iplugincompatibility.h"
@@ -318,6 +319,12 @@ public:
 		return mPlug->GetLatency();
 	}
 
+	uint32 PLUGIN_API getTailSamples() SMTG_OVERRIDE
+	{
+		const int tail = mPlug->GetTailSize();
+		return tail >= 0 ? (uint32)tail : Vst::kInfiniteTail;
+	}
+
 	tresult PLUGIN_API setupProcessing(Vst::ProcessSetup& setup) SMTG_OVERRIDE
 	{
 		const tresult result = Vst::SingleComponentEffect::setupProcessing(setup);
@@ -768,7 +775,12 @@ void IPlugVST3::InformHostOfParamChange(const int idx, double normalizedValue, c
 
 	// TN: While dragging GUI control use clamped parameter value rather
 	// than continuous GUI value; fixes automation for stepped values.
-	if (idx == mouseCap) normalizedValue = GetParam(idx)->GetNormalized();
+	// Note that GUI value might not have been applied to param yet.
+	if (idx == mouseCap)
+	{
+		const IParam* const pParam = GetParam(idx);
+		normalizedValue = pParam->GetNormalized(pParam->GetNonNormalized(normalizedValue));
+	}
 
 	IPlugVST3_Effect* const pEffect = (IPlugVST3_Effect*)mEffect;
 	pEffect->updateParamNormalized(idx, normalizedValue);
@@ -1008,8 +1020,10 @@ tresult IPlugVST3::VSTSetActive(const TBool state)
 
 	if (!(flags & kPlugFlagsActive) == active)
 	{
+		if (!active) EnableGUIParamQueue(false);
 		mPlugFlags = flags ^ kPlugFlagsActive;
 		OnActivate(active);
+		if (active) EnableGUIParamQueue(true);
 	}
 
 	mMutex.Leave();
@@ -1022,20 +1036,17 @@ tresult IPlugVST3::VSTSetState(const int8_t* const data, const size_t size, cons
 {
 	mMutex.Enter();
 
-	ByteChunk* const pChunk = &mState;
-	tresult ok = kResultOk;
-	int pos;
+	// Read directly from host memory (unless compressed).
+	const int n = (int)size;
+	const ByteChunkView chunk(data, n);
+	ByteChunk temp;
+	const ByteChunk* const pChunk = IChunkCodec::DecompressIfCompressed(&chunk, &temp);
 
-	if (pChunk->Size() != size)
-	{
-		pChunk->Resize((int)size);
-		ok = pChunk->Size() == size ? ok : kResultFalse;
-	}
+	tresult ok = n >= 0 && (size_t)n == size ? kResultOk : kResultFalse;
+	int pos;
 
 	if (ok == kResultOk)
 	{
-		memcpy(pChunk->GetBytes(), data, size);
-
 		pos = 0;
 		const int iplugVer = GetIPlugVerFromChunk(pChunk, &pos);
 		ok = iplugVer >= 0x010000 ? ok : kResultFalse;
@@ -1043,6 +1054,7 @@ tresult IPlugVST3::VSTSetState(const int8_t* const data, const size_t size, cons
 
 	if (ok == kResultOk)
 	{
+		DrainGUIParamQueue();
 		pos = UnserializeBank(pChunk, pos);
 		ok = pos >= 0 ? ok : kResultFalse;
 
@@ -1076,6 +1088,7 @@ tresult IPlugVST3::VSTSetState(IBStream* const state)
 	streamer.seek(0, kSeekSet);
 
 	ByteChunk* const pChunk = &mState;
+	ByteChunk temp;
 	tresult ok = kResultOk;
 
 	if (pChunk->Size() != size)
@@ -1090,10 +1103,12 @@ tresult IPlugVST3::VSTSetState(IBStream* const state)
 		ok = n == size ? ok : kResultFalse;
 	}
 
+	const ByteChunk* const pState = ok == kResultOk ? IChunkCodec::DecompressIfCompressed(pChunk, &temp) : pChunk;
+
 	if (ok == kResultOk)
 	{
 		WDL_INT64 bitmask = 1;
-		int pos = pChunk->GetInt64(&bitmask, 0);
+		int pos = pState->GetInt64(&bitmask, 0);
 		const bool bypass = !!(bitmask & 1);
 
 		if (IsBypassed() != bypass)
@@ -1107,7 +1122,8 @@ tresult IPlugVST3::VSTSetState(IBStream* const state)
 
 		if (pos >= 0)
 		{
-			pos = UnserializeState(pChunk, pos);
+			DrainGUIParamQueue();
+			pos = UnserializeState(pState, pos);
 			ok = pos >= 0 ? ok : kResultFalse;
 			OnParamReset();
 		}
@@ -1143,6 +1159,10 @@ tresult IPlugVST3::VSTGetState(IBStream* const state)
 	{
 		ok = SerializeState(pChunk) ? ok : kResultFalse;
 
+		#ifdef IPLUG_COMPRESS_STATE
+		if (ok == kResultOk) ok = IChunkCodec::CompressInPlace(pChunk) ? ok : kResultFalse;
+		#endif
+
 		void* const pData = pChunk->GetBytes();
 		const int size = pChunk->Size();
 
@@ -1192,6 +1212,8 @@ tresult IPlugVST3::VSTProcess(Vst::ProcessData& data)
 {
 	mMutex.Enter();
 
+	ProcessGUIParamChanges();
+
 	const bool is64bits = data.symbolicSampleSize != Vst::kSample32;
 	const int32 nFrames = data.numSamples;
 
@@ -1234,6 +1256,10 @@ tresult IPlugVST3::VSTProcess(Vst::ProcessData& data)
 
 	if (inBus->numChannels >= nInputs && outBus->numChannels >= nOutputs)
 	{
+		// Silence flags are bit per channel, so max 64 channels.
+		assert(nInputs <= 64 && nOutputs <= 64);
+		SetSilentInputs(inBus->silenceFlags);
+
 		if (is64bits)
 		{
 			AttachInputBuffers(0, nInputs, inBus->channelBuffers64, nFrames);
@@ -1246,6 +1272,12 @@ tresult IPlugVST3::VSTProcess(Vst::ProcessData& data)
 			AttachOutputBuffers(0, nOutputs, outBus->channelBuffers32);
 			ProcessBuffers((float)0.0f, nFrames);
 		}
+
+		if (data.numOutputs)
+		{
+			const int32 n = outBus->numChannels;
+			data.outputs[0].silenceFlags = IsOutputSilent() ? (n < 64 ? ((uint64)1 << n) - 1 : ~(uint64)0) : 0;
+		}
 	}
 
 	if (nChanges) FlushParamChanges(pParamChanges, nChanges);
@@ -1259,6 +1291,7 @@ void IPlugVST3::ProcessParamChanges(Vst::IParameterChanges* const pParamChanges,
 	// TN: While dragging GUI control ignore parameter changes; fixes
 	// automation for stepped values.
 	const int mouseCap = GetMouseCapture(GetGUI());
+	int nEvents = 0;
 
 	for (int32 i = 0; i < nChanges; ++i)
 	{
@@ -1267,6 +1300,7 @@ void IPlugVST3::ProcessParamChanges(Vst::IParameterChanges* const pParamChanges,
 
 		const Vst::ParamID id = pParamQueue->getParameterId();
 		const int32 nPoints = pParamQueue->getPointCount();
+		if (nPoints > 0) nEvents += nPoints;
 
 		Vst::ParamValue value;
 		int32 ofs;
@@ -1329,6 +1363,9 @@ void IPlugVST3::ProcessParamChanges(Vst::IParameterChanges* const pParamChanges,
 			ProcessParamChange(id, value);
 		}
 	}
+
+	// Param changes (automation) also wake up plugin, like in IPlugCLAP.
+	CountProcessEvents(nEvents);
 }
 
 void IPlugVST3::ProcessParamChange(const Vst::ParamID id, const Vst::ParamValue value)
@@ -1354,6 +1391,8 @@ void IPlugVST3::ProcessParamChange(const Vst::ParamID id, const Vst::ParamValue
 
 void IPlugVST3::ProcessInputEvents(Vst::IEventList* const pInputEvents, const int32 nEvents)
 {
+	CountProcessEvents(nEvents);
+
 	for (int32 i = 0; i < nEvents; ++i)
 	{
 		Vst::Event event;
@@ -24,6 +24,10 @@
 	#include "IPlugAAX.h"
 	typedef IPlugAAX IPlug;
 	#define API_EXT "aax"
+#elif defined OFFLINE_API
+	#include "IPlugOffline.h"
+	typedef IPlugOffline IPlug;
+	#define API_EXT "offline"
 #else
 	#error "No API defined!"
 #endif
@@ -40,6 +44,10 @@
 	#define PLUG_DOES_MIDI_OUT 0
 #endif
 
+#ifndef PLUG_DOES_SINGLE_REPLACING
+	#define PLUG_DOES_SINGLE_REPLACING 0
+#endif
+
 #define IPLUG_CTOR(nParams, nPresets, instanceInfo) IPlug( \
 	instanceInfo, \
 	nParams, \
@@ -54,5 +62,6 @@
 	PLUG_LATENCY, \
 	(PLUG_IS_INST ? kPlugIsInst : 0) | \
 	(PLUG_DOES_MIDI_IN ? kPlugDoesMidiIn : 0) | \
-	(PLUG_DOES_MIDI_OUT ? kPlugDoesMidiOut : 0) \
+	(PLUG_DOES_MIDI_OUT ? kPlugDoesMidiOut : 0) | \
+	(PLUG_DOES_SINGLE_REPLACING ? kPlugDoesSingleReplacing : 0) \
 )
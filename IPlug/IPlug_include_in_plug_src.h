@@ -39,6 +39,20 @@ IGraphics* MakeGraphics(IPlug* const pPlug, const int w, const int h, const int
 	return pGraphics;
 }
 
+#elif defined(__linux__)
+
+// Offscreen only, see IGraphicsHeadless.h.
+#include "IGraphicsHeadless.h"
+#define EXPORT __attribute__((visibility("default")))
+#ifndef BUNDLE_DOMAIN
+	#define BUNDLE_DOMAIN "com." BUNDLE_MFR
+#endif
+
+IGraphics* MakeGraphics(IPlug* const pPlug, const int w, const int h, const int FPS = 0)
+{
+	return new IGraphicsHeadless(pPlug, w, h, FPS);
+}
+
 #else
 	#error "No OS defined!"
 #endif
@@ -421,6 +435,20 @@ AAX_Result GetEffectDescriptions(AAX_ICollection* pCollection)
 	return err;
 }
 
+#elif defined(OFFLINE_API)
+
+// Command line executable instead of plugin, see IPlugOffline.h.
+int main(const int argc, char** const argv)
+{
+	IPlugOffline* const pPlug = new PLUG_CLASS_NAME(NULL);
+	pPlug->EnsureDefaultPreset();
+
+	const int ret = pPlug->Run(argc, argv);
+
+	delete pPlug;
+	return ret;
+}
+
 #else
 	#error "No API defined!"
 #endif
@@ -0,0 +1,226 @@
+#pragma once
+
+// Per-block process time statistics. The audio thread times each process
+// call, and compares it against the block's real-time budget (nFrames /
+// sample rate). Load is the fraction of the budget used, so > 1.0 is a
+// deadline miss. All statistics are lock-free, so the GUI thread can poll
+// them at any time (e.g. from OnGUITimer()).
+
+#include <atomic>
+#include <chrono>
+
+#include "WDL/wdltypes.h"
+
+class IProcessStats
+{
+public:
+	// Load histogram resolution (for percentiles), and range (0..kMaxLoad).
+	static const int kNumBuckets = 256;
+	static const int kMaxLoad = 2;
+
+	// Number of worst blocks kept in ring buffer.
+	static const int kNumWorstBlocks = 16;
+
+	struct Stats
+	{
+		unsigned int mNBlocks, mNMisses;
+		double mLast, mMax, mP50, mP90, mP99;
+	};
+
+	struct Block
+	{
+		unsigned int mBlockIdx; // Block count at time of recording.
+		int mNFrames, mNEvents;
+		double mLoad;
+	};
+
+	IProcessStats(): mEnabled(false), mStarted(false), mResetRequest(false), mWorstThreshold(kPPM / 2)
+	{
+		ResetNow();
+	}
+
+	// Any thread. Takes effect at next process call.
+	inline void Enable(const bool enable) { mEnabled.store(enable, std::memory_order_relaxed); }
+	inline bool IsEnabled() const { return mEnabled.load(std::memory_order_relaxed); }
+
+	// Any thread. Statistics are cleared by audio thread at next process call.
+	inline void Reset() { mResetRequest.store(true, std::memory_order_relaxed); }
+
+	// Any thread. Blocks with load >= threshold are added to worst blocks
+	// (default 0.5).
+	inline void SetWorstThreshold(const double load) { mWorstThreshold.store(ToPPM(load), std::memory_order_relaxed); }
+
+	// Audio thread: Starts timing. Ignored if already started, so a wrapper
+	// can start before handling events, and include their cost.
+	inline void Begin()
+	{
+		if (!mStarted)
+		{
+			mStarted = true;
+			mStart = std::chrono::steady_clock::now();
+		}
+	}
+
+	// Audio thread: Stops timing, and updates statistics.
+	void End(const int nFrames, const double sampleRate, const int nEvents)
+	{
+		if (!mStarted) return;
+		mStarted = false;
+
+		const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+
+		if (mResetRequest.load(std::memory_order_relaxed))
+		{
+			mResetRequest.store(false, std::memory_order_relaxed);
+			ResetNow();
+		}
+
+		if (nFrames <= 0 || sampleRate <= 0.0) return;
+
+		const unsigned int load = ToPPM(elapsed * sampleRate / (double)nFrames);
+		const unsigned int blockIdx = mNBlocks.load(std::memory_order_relaxed);
+
+		mLast.store(load, std::memory_order_relaxed);
+		if (load > mMax.load(std::memory_order_relaxed)) mMax.store(load, std::memory_order_relaxed);
+		if (load > kPPM) mNMisses.fetch_add(1, std::memory_order_relaxed);
+
+		const int bucket = wdl_min((int)((WDL_UINT64)load * kNumBuckets / (kMaxLoad * kPPM)), kNumBuckets - 1);
+		mHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+
+		if (load >= mWorstThreshold.load(std::memory_order_relaxed))
+		{
+			// Seqlock, so reader can detect partially written blocks.
+			const unsigned int w = mWorstWrite.load(std::memory_order_relaxed);
+			WorstBlock* const pBlock = &mWorst[w % kNumWorstBlocks];
+
+			const unsigned int seq = pBlock->mSeq.load(std::memory_order_relaxed);
+			pBlock->mSeq.store(seq + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			pBlock->mBlockIdx.store(blockIdx, std::memory_order_relaxed);
+			pBlock->mNFrames.store(nFrames, std::memory_order_relaxed);
+			pBlock->mNEvents.store(nEvents, std::memory_order_relaxed);
+			pBlock->mLoad.store(load, std::memory_order_relaxed);
+
+			pBlock->mSeq.store(seq + 2, std::memory_order_release);
+			mWorstWrite.store(w + 1, std::memory_order_release);
+		}
+
+		mNBlocks.store(blockIdx + 1, std::memory_order_release);
+	}
+
+	// Any thread. Percentiles are approximate (histogram bucket upper
+	// bound), and might be slightly inconsistent with the other stats.
+	void GetStats(Stats* const pStats) const
+	{
+		pStats->mNBlocks = mNBlocks.load(std::memory_order_acquire);
+		pStats->mNMisses = mNMisses.load(std::memory_order_relaxed);
+		pStats->mLast = FromPPM(mLast.load(std::memory_order_relaxed));
+		pStats->mMax = FromPPM(mMax.load(std::memory_order_relaxed));
+
+		unsigned int counts[kNumBuckets];
+		unsigned int total = 0;
+
+		for (int i = 0; i < kNumBuckets; ++i)
+		{
+			total += counts[i] = mHistogram[i].load(std::memory_order_relaxed);
+		}
+
+		pStats->mP50 = Percentile(counts, total, 0.50);
+		pStats->mP90 = Percentile(counts, total, 0.90);
+		pStats->mP99 = Percentile(counts, total, 0.99);
+	}
+
+	// Any thread. Copies up to maxBlocks worst blocks, most recent first,
+	// returns number of blocks copied.
+	int GetWorstBlocks(Block* const pBlocks, const int maxBlocks) const
+	{
+		const unsigned int w = mWorstWrite.load(std::memory_order_acquire);
+		const int n = wdl_min((int)wdl_min(w, (unsigned int)kNumWorstBlocks), maxBlocks);
+
+		int nCopied = 0;
+		for (int i = 0; i < n; ++i)
+		{
+			const WorstBlock* const pBlock = &mWorst[(w - 1 - i) % kNumWorstBlocks];
+
+			const unsigned int seq = pBlock->mSeq.load(std::memory_order_acquire);
+			if (seq & 1) continue;
+
+			Block block;
+			block.mBlockIdx = pBlock->mBlockIdx.load(std::memory_order_relaxed);
+			block.mNFrames = pBlock->mNFrames.load(std::memory_order_relaxed);
+			block.mNEvents = pBlock->mNEvents.load(std::memory_order_relaxed);
+			block.mLoad = FromPPM(pBlock->mLoad.load(std::memory_order_relaxed));
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (pBlock->mSeq.load(std::memory_order_relaxed) != seq) continue;
+
+			pBlocks[nCopied++] = block;
+		}
+
+		return nCopied;
+	}
+
+private:
+	// Load is stored as parts per million, so it fits in a lock-free int.
+	static const unsigned int kPPM = 1000000;
+
+	static inline unsigned int ToPPM(const double load)
+	{
+		const double ppm = load * (double)kPPM + 0.5;
+		return ppm < 4.0e9 ? (ppm > 0.0 ? (unsigned int)ppm : 0) : 4000000000u;
+	}
+
+	static inline double FromPPM(const unsigned int ppm) { return (double)ppm * (1.0 / (double)kPPM); }
+
+	static double Percentile(const unsigned int* const pCounts, const unsigned int total, const double p)
+	{
+		if (!total) return 0.0;
+
+		const unsigned int rank = (unsigned int)(p * (double)(total - 1)) + 1;
+		unsigned int sum = 0;
+
+		int i = 0;
+		for (; i < kNumBuckets - 1; ++i)
+		{
+			sum += pCounts[i];
+			if (sum >= rank) break;
+		}
+
+		return (double)((i + 1) * kMaxLoad) / (double)kNumBuckets;
+	}
+
+	// Audio thread (or before processing starts).
+	void ResetNow()
+	{
+		mNBlocks.store(0, std::memory_order_relaxed);
+		mNMisses.store(0, std::memory_order_relaxed);
+		mLast.store(0, std::memory_order_relaxed);
+		mMax.store(0, std::memory_order_relaxed);
+
+		for (int i = 0; i < kNumBuckets; ++i) mHistogram[i].store(0, std::memory_order_relaxed);
+
+		mWorstWrite.store(0, std::memory_order_release);
+	}
+
+	struct WorstBlock
+	{
+		std::atomic<unsigned int> mSeq, mBlockIdx, mLoad;
+		std::atomic<int> mNFrames, mNEvents;
+
+		WorstBlock(): mSeq(0), mBlockIdx(0), mLoad(0), mNFrames(0), mNEvents(0) {}
+	};
+
+	std::atomic<bool> mEnabled;
+	bool mStarted;
+	std::chrono::steady_clock::time_point mStart;
+
+	std::atomic<bool> mResetRequest;
+	std::atomic<unsigned int> mWorstThreshold;
+
+	std::atomic<unsigned int> mNBlocks, mNMisses, mLast, mMax;
+	std::atomic<unsigned int> mHistogram[kNumBuckets];
+
+	std::atomic<unsigned int> mWorstWrite;
+	WorstBlock mWorst[kNumWorstBlocks];
+};
@@ -0,0 +1,577 @@
+/*
+	IVoiceEngine is a polyphonic voice allocator for IPlug instruments. It
+	consumes an IMidiQueue, handles note on/off, sustain pedal, voice
+	stealing, and mono/legato, and renders all active voices in one call
+	per segment between MIDI events (rather than checking for events every
+	sample). Voice state is stored in arrays indexed by voice, so the
+	plugin can keep its own per-voice state (oscillator phase, envelope,
+	etc.) in arrays too, and process voices in batches.
+
+	MySynth.h:
+
+	#include "IPlug/IMidiQueue.h"
+	#include "IPlug/IVoiceEngine.h"
+
+	class MySynth: public IPlug, public IVoiceEngine
+	{
+	public:
+		void ProcessDoubleReplacing(const double* const* inputs, double* const* outputs, int nFrames);
+		void ProcessMidiMsg(const IMidiMsg* pMsg);
+
+	protected:
+		void OnVoiceStart(int voice, bool legato);
+		void OnVoiceRelease(int voice);
+		void RenderVoices(const int* pVoices, int nVoices, int startPos, int nFrames);
+
+	private:
+		IMidiQueue mMidiQueue;
+		double* const* mOutputs;
+
+		double mPhase[kDefaultMaxVoices], mEnv[kDefaultMaxVoices];
+	}
+
+	MySynth.cpp:
+
+	void MySynth::ProcessDoubleReplacing(const double* const* const inputs, double* const* const outputs, const int nFrames)
+	{
+		// To-do: Clear outputs
+
+		mOutputs = outputs;
+		ProcessVoices(&mMidiQueue, nFrames);
+	}
+
+	void MySynth::RenderVoices(const int* const pVoices, const int nVoices, const int startPos, const int nFrames)
+	{
+		for (int i = 0; i < nVoices; ++i)
+		{
+			const int voice = pVoices[i];
+
+			// To-do: Add voice to mOutputs[ch][startPos ... startPos + nFrames - 1]
+
+			if (mEnv[voice] < 1e-5) FreeVoice(voice);
+		}
+	}
+
+	void MySynth::ProcessMidiMsg(const IMidiMsg* const pMsg)
+	{
+		mMidiQueue.Add(pMsg);
+	}
+*/
+
+#pragma once
+
+#include "IMidiQueue.h"
+#include "IPlugStructs.h"
+
+#include "WDL/heapbuf.h"
+#include "WDL/wdltypes.h"
+
+class IVoiceEngine
+{
+public:
+	static const int kDefaultMaxVoices = 16;
+
+	enum EVoiceState
+	{
+		kVoiceFree = 0,
+		kVoiceHeld,      // Key down.
+		kVoiceSustained, // Key up, but sustain pedal down.
+		kVoiceReleased   // Releasing, until plugin calls FreeVoice().
+	};
+
+	enum EVoiceMode
+	{
+		kVoiceModePoly = 0,
+		kVoiceModeMono,  // Single voice, retriggers on every note.
+		kVoiceModeLegato // Single voice, only retriggers if no key is down.
+	};
+
+	// Which voice to steal if all voices are in use. Released voices are
+	// always stolen first, then sustained, then held voices.
+	enum EStealMode
+	{
+		kStealOldest = 0,
+		kStealQuietest, // Uses level set by SetVoiceLevel().
+		kStealLowest,
+		kStealHighest,
+		kStealNone      // Ignore new notes.
+	};
+
+	IVoiceEngine(const int maxVoices = kDefaultMaxVoices)
+	{
+		mVoiceMode = kVoiceModePoly;
+		mStealMode = kStealOldest;
+		SetMaxVoices(maxVoices);
+	}
+
+	virtual ~IVoiceEngine() {}
+
+	// Not real-time safe, call before processing (e.g. in constructor).
+	void SetMaxVoices(int maxVoices)
+	{
+		maxVoices = wdl_max(maxVoices, 1);
+
+		mNote.Resize(maxVoices);
+		mChannel.Resize(maxVoices);
+		mVelocity.Resize(maxVoices);
+		mState.Resize(maxVoices);
+		mOrder.Resize(maxVoices);
+		mLevel.Resize(maxVoices);
+		mActive.Resize(maxVoices);
+
+		ClearVoices();
+	}
+
+	inline int GetMaxVoices() const { return mState.GetSize(); }
+
+	// Kills all voices if mode changes.
+	void SetVoiceMode(const int mode)
+	{
+		if (mode == mVoiceMode) return;
+		KillAllVoices();
+		mVoiceMode = mode;
+	}
+
+	inline int GetVoiceMode() const { return mVoiceMode; }
+
+	inline void SetStealMode(const int mode) { mStealMode = mode; }
+	inline int GetStealMode() const { return mStealMode; }
+
+	// Handles MIDI messages from queue, and calls RenderVoices() for each
+	// segment between messages. Flushes queue.
+	void ProcessVoices(IMidiQueue* const pQueue, const int nFrames)
+	{
+		int pos = 0;
+		do
+		{
+			int next = nFrames;
+			while (!pQueue->Empty())
+			{
+				const IMidiMsg* const pMsg = pQueue->Peek();
+				if (pMsg->mOffset > pos)
+				{
+					next = wdl_min(pMsg->mOffset, nFrames);
+					break;
+				}
+
+				HandleMidiMsg(pMsg);
+				pQueue->Remove();
+			}
+
+			if (mNActive && next > pos)
+			{
+				RenderVoices(mActive.GetFast(), mNActive, pos, next - pos);
+				if (mFreed) CompactActive();
+			}
+
+			pos = next;
+		}
+		while (pos < nFrames);
+
+		pQueue->Flush(nFrames);
+	}
+
+	// Handles note on/off, sustain, all notes/sound off, and passes any
+	// other message (including CCs) to OnVoiceMidiMsg(). Called by
+	// ProcessVoices(), but you can also call it directly (but not from
+	// RenderVoices()).
+	void HandleMidiMsg(const IMidiMsg* const pMsg)
+	{
+		if (mFreed) CompactActive();
+
+		const int status = pMsg->mStatus >> 4;
+		const int ch = pMsg->mStatus & 0x0F;
+
+		switch (status)
+		{
+			case IMidiMsg::kNoteOn:
+			{
+				// Note on with velocity 0 is note off.
+				if (pMsg->mData2)
+					NoteOn(ch, pMsg->mData1, pMsg->mData2);
+				else
+					NoteOff(ch, pMsg->mData1);
+				return;
+			}
+
+			case IMidiMsg::kNoteOff:
+			{
+				NoteOff(ch, pMsg->mData1);
+				return;
+			}
+
+			case IMidiMsg::kControlChange:
+			{
+				switch (pMsg->mData1)
+				{
+					case IMidiMsg::kSustainOnOff:
+					{
+						SetSustain(ch, pMsg->mData2 >= 64);
+						break;
+					}
+
+					case IMidiMsg::kAllNotesOff:
+					{
+						AllNotesOff(ch);
+						break;
+					}
+
+					case IMidiMsg::kAllSoundOff:
+					{
+						KillAllVoices();
+						break;
+					}
+				}
+				break;
+			}
+		}
+
+		OnVoiceMidiMsg(pMsg);
+	}
+
+	// Kills all voices, and resets sustain pedals (e.g. from Reset()).
+	void KillAllVoices()
+	{
+		if (mFreed) CompactActive();
+
+		const int n = mNActive;
+		const int* const pActive = mActive.GetFast();
+
+		for (int i = 0; i < n; ++i) OnVoiceKill(pActive[i]);
+		ClearVoices();
+	}
+
+	inline int GetNumActiveVoices() const { return mNActive; }
+
+	inline int GetVoiceState(const int voice) const { return mState.GetFast()[voice]; }
+	inline int GetVoiceNote(const int voice) const { return mNote.GetFast()[voice]; }
+	inline int GetVoiceChannel(const int voice) const { return mChannel.GetFast()[voice]; }
+	inline int GetVoiceVelocity(const int voice) const { return mVelocity.GetFast()[voice]; }
+
+	// Per voice arrays, e.g. for batch processing in RenderVoices().
+	inline const unsigned char* GetVoiceNotes() const { return mNote.GetFast(); }
+	inline const unsigned char* GetVoiceVelocities() const { return mVelocity.GetFast(); }
+
+	// Optional, for kStealQuietest.
+	inline void SetVoiceLevel(const int voice, const float level) { mLevel.GetFast()[voice] = level; }
+
+	// Call when voice has finished (e.g. from RenderVoices() when release
+	// envelope has ended). Voice will not be rendered after this segment.
+	inline void FreeVoice(const int voice)
+	{
+		mState.GetFast()[voice] = kVoiceFree;
+		mFreed = true;
+	}
+
+protected:
+	// Voice has been allocated for note (which can be read with
+	// GetVoiceNote() etc.). If legato, then voice was already playing, and
+	// note changed without retrigger.
+	virtual void OnVoiceStart(int voice, bool legato) = 0;
+
+	// Note off (or sustain pedal up), start release.
+	virtual void OnVoiceRelease(int voice) = 0;
+
+	// Voice is stolen or killed, and should stop immediately. If stolen,
+	// OnVoiceStart() follows.
+	virtual void OnVoiceKill(int /* voice */) {}
+
+	// Any MIDI message except note on/off, at its sample offset.
+	virtual void OnVoiceMidiMsg(const IMidiMsg* /* pMsg */) {}
+
+	// Renders nVoices active voices (voice indices in pVoices), from
+	// startPos to startPos + nFrames.
+	virtual void RenderVoices(const int* pVoices, int nVoices, int startPos, int nFrames) = 0;
+
+private:
+	void ClearVoices()
+	{
+		memset(mState.GetFast(), kVoiceFree, mState.GetSize() * sizeof(unsigned char));
+		memset(mLevel.GetFast(), 0, mLevel.GetSize() * sizeof(float));
+
+		mNActive = 0;
+		mFreed = false;
+		mOrderCounter = 0;
+		mSustain = 0;
+		mNHeldKeys = 0;
+	}
+
+	void AddActive(const int voice)
+	{
+		mActive.GetFast()[mNActive++] = voice;
+	}
+
+	// Removes freed voices from active list.
+	void CompactActive()
+	{
+		const unsigned char* const pState = mState.GetFast();
+		int* const pActive = mActive.GetFast();
+		int n = 0;
+
+		for (int i = 0; i < mNActive; ++i)
+		{
+			const int voice = pActive[i];
+			if (pState[voice] != kVoiceFree) pActive[n++] = voice;
+		}
+
+		mNActive = n;
+		mFreed = false;
+	}
+
+	void StartVoice(const int voice, const int ch, const int note, const int velocity, const bool legato)
+	{
+		mNote.GetFast()[voice] = note;
+		mChannel.GetFast()[voice] = ch;
+		mVelocity.GetFast()[voice] = velocity;
+		mOrder.GetFast()[voice] = mOrderCounter++;
+
+		unsigned char* const pState = &mState.GetFast()[voice];
+		if (*pState == kVoiceFree) AddActive(voice);
+		*pState = kVoiceHeld;
+
+		OnVoiceStart(voice, legato);
+	}
+
+	void ReleaseVoice(const int voice)
+	{
+		unsigned char* const pState = &mState.GetFast()[voice];
+		if (mSustain & (1 << mChannel.GetFast()[voice]))
+		{
+			*pState = kVoiceSustained;
+		}
+		else
+		{
+			*pState = kVoiceReleased;
+			OnVoiceRelease(voice);
+		}
+	}
+
+	void NoteOn(const int ch, const int note, const int velocity)
+	{
+		if (mVoiceMode != kVoiceModePoly)
+		{
+			MonoNoteOn(ch, note, velocity);
+			return;
+		}
+
+		const int voice = FindVoice(ch, note);
+		if (voice < 0) return;
+
+		// Steal, unless retriggering same note.
+		if (mState.GetFast()[voice] != kVoiceFree && (mNote.GetFast()[voice] != note || mChannel.GetFast()[voice] != ch))
+		{
+			OnVoiceKill(voice);
+		}
+
+		StartVoice(voice, ch, note, velocity, false);
+	}
+
+	void NoteOff(const int ch, const int note)
+	{
+		if (mVoiceMode != kVoiceModePoly)
+		{
+			MonoNoteOff(ch, note);
+			return;
+		}
+
+		const int n = mNActive;
+		const int* const pActive = mActive.GetFast();
+		const unsigned char* const pState = mState.GetFast();
+		const unsigned char* const pNote = mNote.GetFast();
+		const unsigned char* const pChannel = mChannel.GetFast();
+
+		for (int i = 0; i < n; ++i)
+		{
+			const int voice = pActive[i];
+			if (pState[voice] == kVoiceHeld && pNote[voice] == note && pChannel[voice] == ch)
+			{
+				ReleaseVoice(voice);
+			}
+		}
+	}
+
+	// Returns voice to use for new note, or -1 if none.
+	int FindVoice(const int ch, const int note) const
+	{
+		const int maxVoices = GetMaxVoices();
+		const unsigned char* const pState = mState.GetFast();
+
+		// Retrigger same note (e.g. repeated while sustained).
+		const int n = mNActive;
+		const int* const pActive = mActive.GetFast();
+		const unsigned char* const pNote = mNote.GetFast();
+		const unsigned char* const pChannel = mChannel.GetFast();
+
+		for (int i = 0; i < n; ++i)
+		{
+			const int voice = pActive[i];
+			if (pNote[voice] == note && pChannel[voice] == ch && pState[voice] != kVoiceFree) return voice;
+		}
+
+		if (n < maxVoices)
+		{
+			for (int voice = 0; voice < maxVoices; ++voice)
+			{
+				if (pState[voice] == kVoiceFree) return voice;
+			}
+		}
+
+		return mStealMode != kStealNone ? FindVoiceToSteal() : -1;
+	}
+
+	int FindVoiceToSteal() const
+	{
+		const int n = mNActive;
+		const int* const pActive = mActive.GetFast();
+		const unsigned char* const pState = mState.GetFast();
+
+		int best = -1;
+		for (int i = 0; i < n; ++i)
+		{
+			const int voice = pActive[i];
+			if (best < 0 || pState[voice] > pState[best] || (pState[voice] == pState[best] && StealBefore(voice, best)))
+			{
+				best = voice;
+			}
+		}
+
+		return best;
+	}
+
+	// Within same voice state, steal a before b?
+	bool StealBefore(const int a, const int b) const
+	{
+		switch (mStealMode)
+		{
+			case kStealQuietest: return mLevel.GetFast()[a] < mLevel.GetFast()[b];
+			case kStealLowest: return mNote.GetFast()[a] < mNote.GetFast()[b];
+			case kStealHighest: return mNote.GetFast()[a] > mNote.GetFast()[b];
+		}
+
+		// Oldest; order counter can wrap.
+		const unsigned int* const pOrder = mOrder.GetFast();
+		return (int)(pOrder[a] - pOrder[b]) < 0;
+	}
+
+	void SetSustain(const int ch, const bool on)
+	{
+		const int mask = 1 << ch;
+		if (on)
+		{
+			mSustain |= mask;
+			return;
+		}
+
+		if (!(mSustain & mask)) return;
+		mSustain &= ~mask;
+
+		const int n = mNActive;
+		const int* const pActive = mActive.GetFast();
+		unsigned char* const pState = mState.GetFast();
+		const unsigned char* const pChannel = mChannel.GetFast();
+
+		for (int i = 0; i < n; ++i)
+		{
+			const int voice = pActive[i];
+			if (pState[voice] == kVoiceSustained && pChannel[voice] == ch)
+			{
+				pState[voice] = kVoiceReleased;
+				OnVoiceRelease(voice);
+			}
+		}
+	}
+
+	void AllNotesOff(const int ch)
+	{
+		if (mVoiceMode != kVoiceModePoly)
+		{
+			// Forget held keys on channel.
+			int n = 0;
+			for (int i = 0; i < mNHeldKeys; ++i)
+			{
+				if ((mHeldKeys[i] >> 7) != ch) mHeldKeys[n++] = mHeldKeys[i];
+			}
+			mNHeldKeys = n;
+		}
+
+		const int n = mNActive;
+		const int* const pActive = mActive.GetFast();
+		const unsigned char* const pState = mState.GetFast();
+		const unsigned char* const pChannel = mChannel.GetFast();
+
+		for (int i = 0; i < n; ++i)
+		{
+			const int voice = pActive[i];
+			if (pState[voice] == kVoiceHeld && pChannel[voice] == ch) ReleaseVoice(voice);
+		}
+	}
+
+	// Mono/legato: Single voice (0), with stack of held keys (last note
+	// priority), so releasing a key returns to the previous held key.
+
+	void MonoNoteOn(const int ch, const int note, const int velocity)
+	{
+		const int key = ch << 7 | note;
+		RemoveHeldKey(key);
+		if (mNHeldKeys >= kMaxHeldKeys) RemoveHeldKeyAt(0);
+		mHeldKeys[mNHeldKeys++] = key;
+
+		const bool legato = mVoiceMode == kVoiceModeLegato && mState.GetFast()[0] == kVoiceHeld;
+		StartVoice(0, ch, note, velocity, legato);
+	}
+
+	void MonoNoteOff(const int ch, const int note)
+	{
+		const int key = ch << 7 | note;
+		RemoveHeldKey(key);
+
+		if (mState.GetFast()[0] != kVoiceHeld || mNote.GetFast()[0] != note || mChannel.GetFast()[0] != ch) return;
+
+		if (mNHeldKeys)
+		{
+			// Return to previous key, keep velocity.
+			const int prev = mHeldKeys[mNHeldKeys - 1];
+			StartVoice(0, prev >> 7, prev & 0x7F, mVelocity.GetFast()[0], mVoiceMode == kVoiceModeLegato);
+		}
+		else
+		{
+			ReleaseVoice(0);
+		}
+	}
+
+	void RemoveHeldKey(const int key)
+	{
+		for (int i = mNHeldKeys - 1; i >= 0; --i)
+		{
+			if (mHeldKeys[i] == key)
+			{
+				RemoveHeldKeyAt(i);
+				return;
+			}
+		}
+	}
+
+	inline void RemoveHeldKeyAt(const int i)
+	{
+		const int n = --mNHeldKeys - i;
+		memmove(&mHeldKeys[i], &mHeldKeys[i + 1], n * sizeof(short));
+	}
+
+	// Per voice state.
+	WDL_TypedBuf<unsigned char> mNote, mChannel, mVelocity, mState;
+	WDL_TypedBuf<unsigned int> mOrder;
+	WDL_TypedBuf<float> mLevel;
+
+	// Active voice indices.
+	WDL_TypedBuf<int> mActive;
+	int mNActive;
+	bool mFreed;
+
+	int mVoiceMode, mStealMode;
+	unsigned int mOrderCounter;
+	int mSustain; // Bit per channel.
+
+	static const int kMaxHeldKeys = 128;
+	short mHeldKeys[kMaxHeldKeys]; // Channel << 7 | note.
+	int mNHeldKeys;
+};
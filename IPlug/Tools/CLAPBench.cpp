@@ -0,0 +1,843 @@
+// Minimal CLAP host for benchmarking the process path of a CLAP plugin
+// (e.g. built with IPlugCLAP) without a DAW. Loads the plugin with
+// dlopen(), and runs process loops with configurable note, parameter
+// automation, and transport event density. Each run is done twice, first
+// without and then with events, so the cost of event handling can be
+// estimated from the difference. Also times params flush and state
+// save/load.
+//
+// Build (Linux, macOS), from this directory:
+//   c++ -O2 -I../.. -o clapbench CLAPBench.cpp -ldl
+//
+// Run without arguments for usage.
+
+#include <dlfcn.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "CLAP_SDK/clap.h"
+
+#include "WDL/heapbuf.h"
+#include "WDL/wdltypes.h"
+
+static double GetTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int SortDoubles(const void* const a, const void* const b)
+{
+	const double x = *(const double*)a, y = *(const double*)b;
+	return x < y ? -1 : x > y;
+}
+
+// Deterministic, so runs are reproducible.
+static inline unsigned int Rand(unsigned int* const pSeed)
+{
+	return *pSeed = *pSeed * 1664525 + 1013904223;
+}
+
+// ----------------------------------------
+// Host
+
+struct Host
+{
+	clap_host mHost;
+	clap_host_params mHostParams;
+
+	int mNRequestProcess, mNRequestCallback, mNRequestFlush, mNRequestRestart;
+
+	Host();
+
+	static const void* CLAP_ABI GetExtension(const clap_host* pHost, const char* id);
+	static void CLAP_ABI RequestRestart(const clap_host* pHost);
+	static void CLAP_ABI RequestProcess(const clap_host* pHost);
+	static void CLAP_ABI RequestCallback(const clap_host* pHost);
+
+	static void CLAP_ABI ParamsRescan(const clap_host* /* pHost */, uint32_t /* flags */) {}
+	static void CLAP_ABI ParamsClear(const clap_host* /* pHost */, clap_id /* paramID */, uint32_t /* flags */) {}
+	static void CLAP_ABI ParamsRequestFlush(const clap_host* pHost);
+};
+
+Host::Host()
+{
+	static const clap_version version = CLAP_VERSION;
+
+	mHost.clap_version = version;
+	mHost.host_data = this;
+	mHost.name = "CLAPBench";
+	mHost.vendor = "IPlug";
+	mHost.url = NULL;
+	mHost.version = "1.0";
+	mHost.get_extension = GetExtension;
+	mHost.request_restart = RequestRestart;
+	mHost.request_process = RequestProcess;
+	mHost.request_callback = RequestCallback;
+
+	mHostParams.rescan = ParamsRescan;
+	mHostParams.clear = ParamsClear;
+	mHostParams.request_flush = ParamsRequestFlush;
+
+	mNRequestProcess = mNRequestCallback = mNRequestFlush = mNRequestRestart = 0;
+}
+
+const void* CLAP_ABI Host::GetExtension(const clap_host* const pHost, const char* const id)
+{
+	Host* const _this = (Host*)pHost->host_data;
+	return !strcmp(id, CLAP_EXT_PARAMS) ? &_this->mHostParams : NULL;
+}
+
+void CLAP_ABI Host::RequestRestart(const clap_host* const pHost)
+{
+	((Host*)pHost->host_data)->mNRequestRestart++;
+}
+
+void CLAP_ABI Host::RequestProcess(const clap_host* const pHost)
+{
+	((Host*)pHost->host_data)->mNRequestProcess++;
+}
+
+void CLAP_ABI Host::RequestCallback(const clap_host* const pHost)
+{
+	((Host*)pHost->host_data)->mNRequestCallback++;
+}
+
+void CLAP_ABI Host::ParamsRequestFlush(const clap_host* const pHost)
+{
+	((Host*)pHost->host_data)->mNRequestFlush++;
+}
+
+// ----------------------------------------
+// Event lists
+
+union AnyEvent
+{
+	clap_event_header mHeader;
+	clap_event_note mNote;
+	clap_event_param_value mParam;
+	clap_event_midi mMidi;
+};
+
+struct InputEvents
+{
+	clap_input_events mEvents;
+	WDL_TypedBuf<AnyEvent> mBuf;
+	int mSize;
+
+	InputEvents(): mSize(0)
+	{
+		mEvents.ctx = this;
+		mEvents.size = Size;
+		mEvents.get = Get;
+	}
+
+	AnyEvent* Add(const uint32_t time, const uint16_t type, const uint32_t size)
+	{
+		AnyEvent* const pEvent = mBuf.Get() + mSize++;
+		memset(pEvent, 0, sizeof(AnyEvent));
+
+		pEvent->mHeader.size = size;
+		pEvent->mHeader.time = time;
+		pEvent->mHeader.space_id = CLAP_CORE_EVENT_SPACE_ID;
+		pEvent->mHeader.type = type;
+
+		return pEvent;
+	}
+
+	static uint32_t CLAP_ABI Size(const clap_input_events* const pList)
+	{
+		return ((const InputEvents*)pList->ctx)->mSize;
+	}
+
+	static const clap_event_header* CLAP_ABI Get(const clap_input_events* const pList, const uint32_t idx)
+	{
+		const InputEvents* const _this = (const InputEvents*)pList->ctx;
+		return idx < (uint32_t)_this->mSize ? &_this->mBuf.Get()[idx].mHeader : NULL;
+	}
+};
+
+struct OutputEvents
+{
+	clap_output_events mEvents;
+	int mNParams, mNNotes, mNMidi, mNOther;
+
+	OutputEvents()
+	{
+		mEvents.ctx = this;
+		mEvents.try_push = TryPush;
+		mNParams = mNNotes = mNMidi = mNOther = 0;
+	}
+
+	int Total() const { return mNParams + mNNotes + mNMidi + mNOther; }
+
+	static bool CLAP_ABI TryPush(const clap_output_events* const pList, const clap_event_header* const pEvent)
+	{
+		OutputEvents* const _this = (OutputEvents*)pList->ctx;
+
+		if (pEvent->space_id != CLAP_CORE_EVENT_SPACE_ID)
+		{
+			_this->mNOther++;
+			return true;
+		}
+
+		switch (pEvent->type)
+		{
+			case CLAP_EVENT_PARAM_VALUE:
+			case CLAP_EVENT_PARAM_GESTURE_BEGIN:
+			case CLAP_EVENT_PARAM_GESTURE_END:
+				_this->mNParams++;
+				break;
+
+			case CLAP_EVENT_NOTE_ON:
+			case CLAP_EVENT_NOTE_OFF:
+			case CLAP_EVENT_NOTE_END:
+				_this->mNNotes++;
+				break;
+
+			case CLAP_EVENT_MIDI:
+			case CLAP_EVENT_MIDI_SYSEX:
+				_this->mNMidi++;
+				break;
+
+			default:
+				_this->mNOther++;
+				break;
+		}
+
+		return true;
+	}
+};
+
+// ----------------------------------------
+// State streams
+
+struct OStream
+{
+	clap_ostream mStream;
+	WDL_HeapBuf mBuf;
+
+	OStream()
+	{
+		mStream.ctx = this;
+		mStream.write = Write;
+	}
+
+	static int64_t CLAP_ABI Write(const clap_ostream* const pStream, const void* const pBuf, const uint64_t size)
+	{
+		OStream* const _this = (OStream*)pStream->ctx;
+		const int pos = _this->mBuf.GetSize();
+
+		void* const pDest = (char*)_this->mBuf.ResizeOK(pos + (int)size, false);
+		if (!pDest) return -1;
+
+		memcpy((char*)pDest + pos, pBuf, (size_t)size);
+		return (int64_t)size;
+	}
+};
+
+struct IStream
+{
+	clap_istream mStream;
+	const WDL_HeapBuf* mBuf;
+	int mPos;
+
+	IStream(const WDL_HeapBuf* const pBuf): mBuf(pBuf), mPos(0)
+	{
+		mStream.ctx = this;
+		mStream.read = Read;
+	}
+
+	static int64_t CLAP_ABI Read(const clap_istream* const pStream, void* const pBuf, const uint64_t size)
+	{
+		IStream* const _this = (IStream*)pStream->ctx;
+		const int n = (int)wdl_min(size, (uint64_t)(_this->mBuf->GetSize() - _this->mPos));
+
+		memcpy(pBuf, (const char*)_this->mBuf->Get() + _this->mPos, n);
+		_this->mPos += n;
+		return n;
+	}
+};
+
+// ----------------------------------------
+// Benchmark
+
+struct Options
+{
+	const char* mPath;
+	const char* mID;
+	double mSampleRate, mLength;
+	int mBlockSize;
+	double mNotesPerSec;
+	int mParamsPerBlock;
+	bool mTransport, mMidi, mIs64bits;
+	int mStateIterations;
+};
+
+struct Stats
+{
+	double mMean, mP50, mP90, mP99, mMax; // Seconds.
+	int mNOver;
+};
+
+class Bench
+{
+public:
+	Bench(const Options* pOptions, const clap_plugin* pPlug, Host* pHost);
+
+	bool Init();
+	void Run(bool withEvents, Stats* pStats);
+	void RunFlush(double* pTime);
+	bool RunState(double* pSaveTime, double* pLoadTime, int* pSize);
+
+	int NEventsIn() const { return mNEventsIn; }
+	const OutputEvents* GetOutputEvents() const { return &mOutEvents; }
+
+private:
+	void MakeEvents(int pos, int nFrames);
+
+	const Options* mOptions;
+	const clap_plugin* mPlug;
+	Host* mHost;
+
+	const clap_plugin_params* mParams;
+	const clap_plugin_state* mState;
+
+	WDL_TypedBuf<clap_id> mParamIDs;
+	WDL_TypedBuf<double> mParamMin, mParamMax;
+
+	int mNInputs, mNOutputs;
+	WDL_TypedBuf<double> mBuf64;
+	WDL_TypedBuf<float> mBuf32;
+	WDL_TypedBuf<double*> mPtrs64;
+	WDL_TypedBuf<float*> mPtrs32;
+
+	InputEvents mInEvents;
+	OutputEvents mOutEvents;
+
+	double mNoteAcc;
+	unsigned int mSeed;
+	int mNoteKey, mParamIdx, mNEventsIn;
+
+	WDL_TypedBuf<double> mBlockTime;
+};
+
+Bench::Bench(const Options* const pOptions, const clap_plugin* const pPlug, Host* const pHost)
+:	mOptions(pOptions),
+	mPlug(pPlug),
+	mHost(pHost),
+	mParams(NULL),
+	mState(NULL),
+	mNInputs(0),
+	mNOutputs(0),
+	mNoteAcc(0.0),
+	mSeed(1),
+	mNoteKey(-1),
+	mParamIdx(0),
+	mNEventsIn(0)
+{}
+
+bool Bench::Init()
+{
+	const clap_plugin* const pPlug = mPlug;
+	const int blockSize = mOptions->mBlockSize;
+
+	// Audio ports, main (first) port only.
+	const clap_plugin_audio_ports* const pPorts = (const clap_plugin_audio_ports*)pPlug->get_extension(pPlug, CLAP_EXT_AUDIO_PORTS);
+	if (pPorts)
+	{
+		clap_audio_port_info info;
+		if (pPorts->count(pPlug, true) && pPorts->get(pPlug, 0, true, &info)) mNInputs = info.channel_count;
+		if (pPorts->count(pPlug, false) && pPorts->get(pPlug, 0, false, &info)) mNOutputs = info.channel_count;
+	}
+
+	const int nChannels = mNInputs + mNOutputs;
+	const int bufSize = nChannels * blockSize;
+
+	if (mOptions->mIs64bits)
+	{
+		double* const pBuf = mBuf64.ResizeOK(bufSize, false);
+		double** const ppPtrs = mPtrs64.ResizeOK(nChannels, false);
+		if ((!pBuf || !ppPtrs) && nChannels) return false;
+		for (int ch = 0; ch < nChannels; ++ch) ppPtrs[ch] = pBuf + ch * blockSize;
+	}
+	else
+	{
+		float* const pBuf = mBuf32.ResizeOK(bufSize, false);
+		float** const ppPtrs = mPtrs32.ResizeOK(nChannels, false);
+		if ((!pBuf || !ppPtrs) && nChannels) return false;
+		for (int ch = 0; ch < nChannels; ++ch) ppPtrs[ch] = pBuf + ch * blockSize;
+	}
+
+	// Automatable parameters.
+	mParams = (const clap_plugin_params*)pPlug->get_extension(pPlug, CLAP_EXT_PARAMS);
+	if (mParams)
+	{
+		const int n = mParams->count(pPlug);
+		for (int i = 0; i < n; ++i)
+		{
+			clap_param_info info;
+			if (mParams->get_info(pPlug, i, &info) && (info.flags & CLAP_PARAM_IS_AUTOMATABLE))
+			{
+				mParamIDs.Add(info.id);
+				mParamMin.Add(info.min_value);
+				mParamMax.Add(info.max_value);
+			}
+		}
+	}
+
+	mState = (const clap_plugin_state*)pPlug->get_extension(pPlug, CLAP_EXT_STATE);
+
+	// Worst case events per block: note off + note on per frame, and params.
+	const int maxEvents = 2 * blockSize + wdl_max(mOptions->mParamsPerBlock, 0);
+	return !!mInEvents.mBuf.ResizeOK(maxEvents, false);
+}
+
+void Bench::MakeEvents(const int pos, const int nFrames)
+{
+	mInEvents.mSize = 0;
+
+	// Notes, evenly spaced (monophonic, so note off for previous note at
+	// same time as next note on).
+	const double notesPerFrame = mOptions->mNotesPerSec / mOptions->mSampleRate;
+	int nNotes = 0;
+
+	if (notesPerFrame > 0.0)
+	{
+		mNoteAcc += notesPerFrame * (double)nFrames;
+		nNotes = wdl_min((int)mNoteAcc, nFrames);
+		mNoteAcc -= (double)nNotes;
+	}
+
+	// Parameters, evenly spaced, cycling through params.
+	const int nAutomatable = mParamIDs.GetSize();
+	const int nParams = nAutomatable ? mOptions->mParamsPerBlock : 0;
+
+	for (int iNote = 0, iParam = 0; iNote < nNotes || iParam < nParams; )
+	{
+		const uint32_t noteTime = nNotes ? (uint32_t)(iNote * nFrames / nNotes) : nFrames;
+		const uint32_t paramTime = nParams ? (uint32_t)(iParam * nFrames / nParams) : nFrames;
+
+		if (iNote < nNotes && (iParam >= nParams || noteTime <= paramTime))
+		{
+			const int key = 36 + (int)(Rand(&mSeed) % 48);
+
+			if (mNoteKey >= 0)
+			{
+				if (mOptions->mMidi)
+				{
+					AnyEvent* const pEvent = mInEvents.Add(noteTime, CLAP_EVENT_MIDI, sizeof(clap_event_midi));
+					pEvent->mMidi.data[0] = 0x80;
+					pEvent->mMidi.data[1] = (uint8_t)mNoteKey;
+				}
+				else
+				{
+					AnyEvent* const pEvent = mInEvents.Add(noteTime, CLAP_EVENT_NOTE_OFF, sizeof(clap_event_note));
+					pEvent->mNote.note_id = -1;
+					pEvent->mNote.key = (int16_t)mNoteKey;
+				}
+			}
+
+			if (mOptions->mMidi)
+			{
+				AnyEvent* const pEvent = mInEvents.Add(noteTime, CLAP_EVENT_MIDI, sizeof(clap_event_midi));
+				pEvent->mMidi.data[0] = 0x90;
+				pEvent->mMidi.data[1] = (uint8_t)key;
+				pEvent->mMidi.data[2] = 100;
+			}
+			else
+			{
+				AnyEvent* const pEvent = mInEvents.Add(noteTime, CLAP_EVENT_NOTE_ON, sizeof(clap_event_note));
+				pEvent->mNote.note_id = -1;
+				pEvent->mNote.key = (int16_t)key;
+				pEvent->mNote.velocity = 100.0 / 127.0;
+			}
+
+			mNoteKey = key;
+			++iNote;
+		}
+		else
+		{
+			const int idx = mParamIdx;
+			mParamIdx = (idx + 1) % nAutomatable;
+
+			// Slow sine sweep through parameter range.
+			const double t = (double)(pos + paramTime) / mOptions->mSampleRate;
+			const double x = 0.5 + 0.5 * sin(2.0 * 3.14159265358979323846 * 0.25 * t + (double)idx);
+
+			const double min = mParamMin.Get()[idx], max = mParamMax.Get()[idx];
+
+			AnyEvent* const pEvent = mInEvents.Add(paramTime, CLAP_EVENT_PARAM_VALUE, sizeof(clap_event_param_value));
+			pEvent->mParam.param_id = mParamIDs.Get()[idx];
+			pEvent->mParam.note_id = -1;
+			pEvent->mParam.port_index = pEvent->mParam.channel = pEvent->mParam.key = -1;
+			pEvent->mParam.value = min + x * (max - min);
+
+			++iParam;
+		}
+	}
+
+	mNEventsIn += mInEvents.mSize;
+}
+
+void Bench::Run(const bool withEvents, Stats* const pStats)
+{
+	const clap_plugin* const pPlug = mPlug;
+
+	const double sampleRate = mOptions->mSampleRate;
+	const int blockSize = mOptions->mBlockSize;
+	const int nFrames = (int)(mOptions->mLength * sampleRate + 0.5);
+	const int nBlocks = (nFrames + blockSize - 1) / blockSize;
+
+	double* const pTime = mBlockTime.Resize(nBlocks, false);
+
+	// Noise input, silent output.
+	unsigned int seed = 1;
+	if (mOptions->mIs64bits)
+	{
+		double* const pBuf = mBuf64.Get();
+		for (int i = 0; i < mNInputs * blockSize; ++i) pBuf[i] = (double)(int)Rand(&seed) * (0.5 / 2147483648.0);
+		memset(pBuf + mNInputs * blockSize, 0, mNOutputs * blockSize * sizeof(double));
+	}
+	else
+	{
+		float* const pBuf = mBuf32.Get();
+		for (int i = 0; i < mNInputs * blockSize; ++i) pBuf[i] = (float)(int)Rand(&seed) * (0.5f / 2147483648.0f);
+		memset(pBuf + mNInputs * blockSize, 0, mNOutputs * blockSize * sizeof(float));
+	}
+
+	clap_audio_buffer inBuf, outBuf;
+	memset(&inBuf, 0, sizeof(inBuf));
+	memset(&outBuf, 0, sizeof(outBuf));
+
+	inBuf.channel_count = mNInputs;
+	outBuf.channel_count = mNOutputs;
+
+	if (mOptions->mIs64bits)
+	{
+		inBuf.data64 = mPtrs64.Get();
+		outBuf.data64 = mPtrs64.Get() + mNInputs;
+	}
+	else
+	{
+		inBuf.data32 = mPtrs32.Get();
+		outBuf.data32 = mPtrs32.Get() + mNInputs;
+	}
+
+	clap_event_transport transport;
+	memset(&transport, 0, sizeof(transport));
+
+	transport.header.size = sizeof(transport);
+	transport.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+	transport.header.type = CLAP_EVENT_TRANSPORT;
+	transport.flags = CLAP_TRANSPORT_HAS_TEMPO | CLAP_TRANSPORT_HAS_SECONDS_TIMELINE | CLAP_TRANSPORT_HAS_TIME_SIGNATURE | CLAP_TRANSPORT_IS_PLAYING;
+	transport.tempo = 120.0;
+	transport.tsig_num = transport.tsig_denom = 4;
+
+	clap_process process;
+	memset(&process, 0, sizeof(process));
+
+	process.audio_inputs = &inBuf;
+	process.audio_outputs = &outBuf;
+	process.audio_inputs_count = mNInputs ? 1 : 0;
+	process.audio_outputs_count = mNOutputs ? 1 : 0;
+	process.in_events = &mInEvents.mEvents;
+	process.out_events = &mOutEvents.mEvents;
+
+	const bool sendTransport = withEvents && mOptions->mTransport;
+
+	mInEvents.mSize = 0;
+	mNoteAcc = 0.0;
+	mSeed = 1;
+	mNoteKey = -1;
+	mParamIdx = 0;
+
+	for (int block = 0, pos = 0; block < nBlocks; ++block, pos += blockSize)
+	{
+		const int n = wdl_min(blockSize, nFrames - pos);
+
+		if (withEvents) MakeEvents(pos, n);
+
+		process.steady_time = pos;
+		process.frames_count = n;
+
+		if (sendTransport)
+		{
+			transport.song_pos_seconds = (clap_sectime)((double)pos / sampleRate * (double)CLAP_SECTIME_FACTOR);
+			process.transport = &transport;
+		}
+
+		const double start = GetTime();
+		pPlug->process(pPlug, &process);
+		pTime[block] = GetTime() - start;
+	}
+
+	double sum = 0.0;
+	int nOver = 0;
+
+	const double budget = (double)blockSize / sampleRate;
+	for (int i = 0; i < nBlocks; ++i)
+	{
+		sum += pTime[i];
+		nOver += pTime[i] > budget;
+	}
+
+	qsort(pTime, nBlocks, sizeof(double), SortDoubles);
+
+	#define PERCENTILE(p) (nBlocks ? pTime[(int)((double)(p) * (nBlocks - 1) + 0.5)] : 0.0)
+
+	pStats->mMean = nBlocks ? sum / (double)nBlocks : 0.0;
+	pStats->mP50 = PERCENTILE(0.50);
+	pStats->mP90 = PERCENTILE(0.90);
+	pStats->mP99 = PERCENTILE(0.99);
+	pStats->mMax = PERCENTILE(1.0);
+	pStats->mNOver = nOver;
+
+	#undef PERCENTILE
+}
+
+void Bench::RunFlush(double* const pTime)
+{
+	*pTime = 0.0;
+	if (!mParams || !mParamIDs.GetSize()) return;
+
+	// Same param events as one block (without notes), outside of process.
+	mInEvents.mSize = 0;
+	const int nParams = wdl_max(mOptions->mParamsPerBlock, 1);
+	const int nAutomatable = mParamIDs.GetSize();
+
+	for (int i = 0; i < nParams && i < mInEvents.mBuf.GetSize(); ++i)
+	{
+		const int idx = i % nAutomatable;
+		AnyEvent* const pEvent = mInEvents.Add(0, CLAP_EVENT_PARAM_VALUE, sizeof(clap_event_param_value));
+		pEvent->mParam.param_id = mParamIDs.Get()[idx];
+		pEvent->mParam.note_id = -1;
+		pEvent->mParam.port_index = pEvent->mParam.channel = pEvent->mParam.key = -1;
+		pEvent->mParam.value = mParamMin.Get()[idx];
+	}
+
+	static const int nIterations = 100;
+
+	const double start = GetTime();
+	for (int i = 0; i < nIterations; ++i) mParams->flush(mPlug, &mInEvents.mEvents, &mOutEvents.mEvents);
+	*pTime = (GetTime() - start) / (double)nIterations;
+
+	mInEvents.mSize = 0;
+}
+
+bool Bench::RunState(double* const pSaveTime, double* const pLoadTime, int* const pSize)
+{
+	*pSaveTime = *pLoadTime = 0.0;
+	*pSize = 0;
+
+	const int n = mOptions->mStateIterations;
+	if (!mState || n <= 0) return true;
+
+	OStream out;
+	double saveTime = 0.0, loadTime = 0.0;
+
+	for (int i = 0; i < n; ++i)
+	{
+		out.mBuf.Resize(0, false);
+
+		double start = GetTime();
+		const bool saved = mState->save(mPlug, &out.mStream);
+		saveTime += GetTime() - start;
+
+		IStream in(&out.mBuf);
+
+		start = GetTime();
+		const bool loaded = saved && mState->load(mPlug, &in.mStream);
+		loadTime += GetTime() - start;
+
+		if (!loaded) return false;
+	}
+
+	*pSaveTime = saveTime / (double)n;
+	*pLoadTime = loadTime / (double)n;
+	*pSize = out.mBuf.GetSize();
+
+	return true;
+}
+
+// ----------------------------------------
+
+static void PrintUsage(const char* const exe)
+{
+	const char* const file = strrchr(exe, '/');
+
+	printf(
+		"Usage: %s <plugin.clap> [options]\n"
+		"\n"
+		"  -id <plugin ID>    Plugin to load (default first in factory)\n"
+		"  -sr <Hz>           Sample rate (default 44100)\n"
+		"  -bs <frames>       Block size (default 512)\n"
+		"  -len <seconds>     Length of each run (default 10)\n"
+		"  -notes <per sec>   Note on/off pairs per second (default 0)\n"
+		"  -params <n>        Parameter changes per block (default 0)\n"
+		"  -transport         Send transport info with each block\n"
+		"  -midi              Send notes as MIDI events instead of CLAP notes\n"
+		"  -float             Use 32-bit float buffers (default 64-bit)\n"
+		"  -state <n>         State save/load iterations (default 10)\n",
+		file ? file + 1 : exe);
+}
+
+static void PrintStats(const char* const name, const Stats* const pStats, const double budget)
+{
+	printf("%s (us): mean %.2f, p50 %.2f, p90 %.2f, p99 %.2f, max %.2f; %d blocks over %.1f budget\n",
+		name, 1.0e6 * pStats->mMean, 1.0e6 * pStats->mP50, 1.0e6 * pStats->mP90,
+		1.0e6 * pStats->mP99, 1.0e6 * pStats->mMax, pStats->mNOver, 1.0e6 * budget);
+}
+
+int main(const int argc, const char* const* const argv)
+{
+	Options opt;
+	memset(&opt, 0, sizeof(opt));
+
+	opt.mSampleRate = 44100.0;
+	opt.mBlockSize = 512;
+	opt.mLength = 10.0;
+	opt.mIs64bits = true;
+	opt.mStateIterations = 10;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* const arg = argv[i];
+		const char* const val = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (*arg != '-')
+		{
+			if (opt.mPath) break;
+			opt.mPath = arg;
+		}
+		else if (!strcmp(arg, "-transport")) opt.mTransport = true;
+		else if (!strcmp(arg, "-midi")) opt.mMidi = true;
+		else if (!strcmp(arg, "-float")) opt.mIs64bits = false;
+		else if (!val) { opt.mPath = NULL; break; }
+		else if (!strcmp(arg, "-id")) opt.mID = argv[++i];
+		else if (!strcmp(arg, "-sr")) opt.mSampleRate = atof(argv[++i]);
+		else if (!strcmp(arg, "-bs")) opt.mBlockSize = atoi(argv[++i]);
+		else if (!strcmp(arg, "-len")) opt.mLength = atof(argv[++i]);
+		else if (!strcmp(arg, "-notes")) opt.mNotesPerSec = atof(argv[++i]);
+		else if (!strcmp(arg, "-params")) opt.mParamsPerBlock = atoi(argv[++i]);
+		else if (!strcmp(arg, "-state")) opt.mStateIterations = atoi(argv[++i]);
+		else { opt.mPath = NULL; break; }
+	}
+
+	if (!opt.mPath || opt.mSampleRate <= 0.0 || opt.mBlockSize <= 0 || opt.mLength < 0.0)
+	{
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	// Load plugin.
+
+	void* const hLib = dlopen(opt.mPath, RTLD_NOW | RTLD_LOCAL);
+	if (!hLib)
+	{
+		fprintf(stderr, "%s\n", dlerror());
+		return 1;
+	}
+
+	const clap_plugin_entry* const pEntry = (const clap_plugin_entry*)dlsym(hLib, "clap_entry");
+	if (!pEntry || !pEntry->init(opt.mPath))
+	{
+		fprintf(stderr, "No CLAP entry point\n");
+		dlclose(hLib);
+		return 1;
+	}
+
+	int ret = 1;
+	const clap_plugin_factory* const pFactory = (const clap_plugin_factory*)pEntry->get_factory(CLAP_PLUGIN_FACTORY_ID);
+
+	const clap_plugin_descriptor* pDesc = NULL;
+	const int nPlugs = pFactory ? pFactory->get_plugin_count(pFactory) : 0;
+
+	for (int i = 0; i < nPlugs && !pDesc; ++i)
+	{
+		const clap_plugin_descriptor* const pCur = pFactory->get_plugin_descriptor(pFactory, i);
+		if (pCur && (!opt.mID || !strcmp(pCur->id, opt.mID))) pDesc = pCur;
+	}
+
+	Host host;
+	const clap_plugin* const pPlug = pDesc ? pFactory->create_plugin(pFactory, &host.mHost, pDesc->id) : NULL;
+
+	if (pPlug && pPlug->init(pPlug))
+	{
+		Bench bench(&opt, pPlug, &host);
+
+		if (bench.Init() && pPlug->activate(pPlug, opt.mSampleRate, 1, opt.mBlockSize) && pPlug->start_processing(pPlug))
+		{
+			Stats base, events;
+
+			// Warm up caches first.
+			bench.Run(false, &base);
+			bench.Run(false, &base);
+			pPlug->reset(pPlug);
+			bench.Run(true, &events);
+
+			pPlug->stop_processing(pPlug);
+
+			double flushTime;
+			bench.RunFlush(&flushTime);
+
+			pPlug->deactivate(pPlug);
+
+			double saveTime, loadTime;
+			int stateSize;
+			const bool stateOK = bench.RunState(&saveTime, &loadTime, &stateSize);
+
+			const double budget = (double)opt.mBlockSize / opt.mSampleRate;
+			const int nBlocks = (int)((opt.mLength * opt.mSampleRate + 0.5 + opt.mBlockSize - 1) / opt.mBlockSize);
+			const int nEventsIn = bench.NEventsIn();
+			const OutputEvents* const pOut = bench.GetOutputEvents();
+
+			printf("%s (%s): %.0f Hz, block size %d, %d-bit, %d blocks\n",
+				pDesc->name, pDesc->id, opt.mSampleRate, opt.mBlockSize, opt.mIs64bits ? 64 : 32, nBlocks);
+
+			PrintStats("No events", &base, budget);
+			PrintStats("Events   ", &events, budget);
+
+			printf("Events in: %d (%.1f per block), out: %d (%d param, %d note, %d MIDI, %d other)\n",
+				nEventsIn, nBlocks ? (double)nEventsIn / (double)nBlocks : 0.0,
+				pOut->Total(), pOut->mNParams, pOut->mNNotes, pOut->mNMidi, pOut->mNOther);
+
+			if (nEventsIn)
+			{
+				const double cost = (events.mMean - base.mMean) * (double)nBlocks / (double)nEventsIn;
+				printf("Event cost (ns): %.1f per event\n", 1.0e9 * cost);
+			}
+
+			if (flushTime > 0.0) printf("Params flush (us): %.2f\n", 1.0e6 * flushTime);
+
+			if (!stateOK)
+				printf("State save/load failed\n");
+			else if (stateSize)
+				printf("State (us): save %.2f, load %.2f, %d bytes\n", 1.0e6 * saveTime, 1.0e6 * loadTime, stateSize);
+
+			printf("Host requests: %d process, %d callback, %d flush, %d restart\n",
+				host.mNRequestProcess, host.mNRequestCallback, host.mNRequestFlush, host.mNRequestRestart);
+
+			ret = stateOK ? 0 : 1;
+		}
+		else
+		{
+			fprintf(stderr, "Could not activate plugin\n");
+		}
+
+		pPlug->destroy(pPlug);
+	}
+	else
+	{
+		fprintf(stderr, "Could not create plugin\n");
+		if (pPlug) pPlug->destroy(pPlug);
+	}
+
+	pEntry->deinit();
+	dlclose(hLib);
+
+	return ret;
+}
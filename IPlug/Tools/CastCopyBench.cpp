@@ -0,0 +1,223 @@
+// Benchmarks the float <-> double sample conversions done by
+// IPlugBase::CastCopy() and CastCopyAccumulating(), comparing the plain
+// C++ loops against the SSE2, AVX, and NEON kernels in ICastCopy.h (those
+// supported by the build and CPU). Each kernel is first checked against
+// the plain C++ loop for all lengths 0..69 at aligned and unaligned
+// offsets, and then timed for the given block size at offset 0 and 1.
+// Reports time per sample, and the number of mismatches (should be 0).
+//
+// Build (Linux, macOS), from this directory:
+//   c++ -O2 -I../.. -o castcopybench CastCopyBench.cpp
+//   c++ -O2 -I../.. -DIPLUG_NO_SIMD -o castcopybench CastCopyBench.cpp
+//
+// Usage: castcopybench [block size] [number of blocks]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "IPlug/ICastCopy.h"
+#include "WDL/heapbuf.h"
+
+static double GetTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Deterministic, so runs are reproducible.
+static inline unsigned int Rand(unsigned int* const pSeed)
+{
+	return *pSeed = *pSeed * 1664525 + 1013904223;
+}
+
+static inline double RandSample(unsigned int* const pSeed)
+{
+	return (double)(int)Rand(pSeed) * (1.0 / 2147483648.0);
+}
+
+// Plain C++, same as the IPlugBase::CastCopy() templates.
+
+static int CastFloatToDoubleScalar(double* const pDest, const float* const pSrc, const int n)
+{
+	for (int i = 0; i < n; ++i) pDest[i] = (double)pSrc[i];
+	return n;
+}
+
+static int CastDoubleToFloatScalar(float* const pDest, const double* const pSrc, const int n)
+{
+	for (int i = 0; i < n; ++i) pDest[i] = (float)pSrc[i];
+	return n;
+}
+
+static int CastDoubleToFloatAccumulatingScalar(float* const pDest, const double* const pSrc, const int n)
+{
+	for (int i = 0; i < n; ++i) pDest[i] += (float)pSrc[i];
+	return n;
+}
+
+typedef int (*FloatToDoubleFunc)(double* pDest, const float* pSrc, int n);
+typedef int (*DoubleToFloatFunc)(float* pDest, const double* pSrc, int n);
+
+struct Kernels
+{
+	const char* mName;
+	FloatToDoubleFunc mFloatToDouble;
+	DoubleToFloatFunc mDoubleToFloat, mDoubleToFloatAccumulating;
+};
+
+static const Kernels sScalar =
+{
+	"scalar", CastFloatToDoubleScalar, CastDoubleToFloatScalar, CastDoubleToFloatAccumulatingScalar
+};
+
+// Finishes remaining samples in plain C++, like IPlugBase does.
+
+static void FloatToDouble(const Kernels* const pKernels, double* const pDest, const float* const pSrc, const int n)
+{
+	const int i = pKernels->mFloatToDouble(pDest, pSrc, n);
+	CastFloatToDoubleScalar(&pDest[i], &pSrc[i], n - i);
+}
+
+static void DoubleToFloat(const Kernels* const pKernels, float* const pDest, const double* const pSrc, const int n)
+{
+	const int i = pKernels->mDoubleToFloat(pDest, pSrc, n);
+	CastDoubleToFloatScalar(&pDest[i], &pSrc[i], n - i);
+}
+
+static void DoubleToFloatAccumulating(const Kernels* const pKernels, float* const pDest, const double* const pSrc, const int n)
+{
+	const int i = pKernels->mDoubleToFloatAccumulating(pDest, pSrc, n);
+	CastDoubleToFloatAccumulatingScalar(&pDest[i], &pSrc[i], n - i);
+}
+
+static const int kMaxCheckLen = 70, kMaxOffset = 3;
+
+static int Check(const Kernels* const pKernels)
+{
+	const int size = kMaxCheckLen + kMaxOffset;
+	float fSrc[size], fDest[size], fRef[size];
+	double dSrc[size], dDest[size], dRef[size];
+
+	unsigned int seed = 1;
+	int nErrors = 0;
+
+	for (int ofs = 0; ofs <= kMaxOffset; ++ofs)
+	{
+		for (int n = 0; n < kMaxCheckLen; ++n)
+		{
+			for (int i = 0; i < size; ++i)
+			{
+				dSrc[i] = RandSample(&seed);
+				fSrc[i] = (float)RandSample(&seed);
+				fDest[i] = fRef[i] = (float)RandSample(&seed);
+				dDest[i] = dRef[i] = 0.0;
+			}
+
+			FloatToDouble(pKernels, &dDest[ofs], &fSrc[ofs], n);
+			FloatToDouble(&sScalar, &dRef[ofs], &fSrc[ofs], n);
+			nErrors += !!memcmp(dDest, dRef, sizeof(dDest));
+
+			DoubleToFloatAccumulating(pKernels, &fDest[ofs], &dSrc[ofs], n);
+			DoubleToFloatAccumulating(&sScalar, &fRef[ofs], &dSrc[ofs], n);
+			nErrors += !!memcmp(fDest, fRef, sizeof(fDest));
+
+			DoubleToFloat(pKernels, &fDest[ofs], &dSrc[ofs], n);
+			DoubleToFloat(&sScalar, &fRef[ofs], &dSrc[ofs], n);
+			nErrors += !!memcmp(fDest, fRef, sizeof(fDest));
+		}
+	}
+
+	return nErrors;
+}
+
+// Prevents the compiler from optimizing away the conversions.
+static volatile float sSink;
+
+static void Run(const Kernels* const pKernels, const int blockSize, const int nBlocks)
+{
+	WDL_TypedBuf<float> fBuf;
+	WDL_TypedBuf<double> dBuf;
+
+	float* const pFloat = fBuf.Resize(blockSize + 1);
+	double* const pDouble = dBuf.Resize(blockSize + 1);
+
+	unsigned int seed = 1;
+	for (int i = 0; i <= blockSize; ++i) pFloat[i] = (float)RandSample(&seed);
+
+	const int nErrors = Check(pKernels);
+
+	printf("%-8s", pKernels->mName);
+
+	for (int ofs = 0; ofs <= 1; ++ofs)
+	{
+		double time[3];
+
+		double start = GetTime();
+		for (int i = 0; i < nBlocks; ++i) FloatToDouble(pKernels, &pDouble[ofs], &pFloat[ofs], blockSize);
+		time[0] = GetTime() - start;
+
+		start = GetTime();
+		for (int i = 0; i < nBlocks; ++i) DoubleToFloat(pKernels, &pFloat[ofs], &pDouble[ofs], blockSize);
+		time[1] = GetTime() - start;
+
+		start = GetTime();
+		for (int i = 0; i < nBlocks; ++i) DoubleToFloatAccumulating(pKernels, &pFloat[ofs], &pDouble[ofs], blockSize);
+		time[2] = GetTime() - start;
+
+		sSink = pFloat[blockSize / 2];
+
+		const double scale = 1e9 / ((double)blockSize * (double)nBlocks);
+		printf("  %6.3f %6.3f %6.3f", time[0] * scale, time[1] * scale, time[2] * scale);
+	}
+
+	printf("  %d mismatches\n", nErrors);
+}
+
+int main(const int argc, const char* const* const argv)
+{
+	const int blockSize = argc > 1 ? atoi(argv[1]) : 512;
+	const int nBlocks = argc > 2 ? atoi(argv[2]) : 200000;
+
+	if (blockSize <= 0 || nBlocks <= 0)
+	{
+		fprintf(stderr, "Usage: %s [block size] [number of blocks]\n", argv[0]);
+		return 1;
+	}
+
+	printf("%d samples/block, %d blocks, ns/sample\n", blockSize, nBlocks);
+	printf("%-8s  %-20s  %-20s\n", "", "aligned", "unaligned (+1)");
+	printf("%-8s  %6s %6s %6s  %6s %6s %6s\n", "", "f->d", "d->f", "d+=f", "f->d", "d->f", "d+=f");
+
+	Run(&sScalar, blockSize, nBlocks);
+
+	#ifdef IPLUG_SIMD_SSE2
+	static const Kernels sSSE2 =
+	{
+		"SSE2", CastFloatToDoubleSSE2, CastDoubleToFloatSSE2, CastDoubleToFloatAccumulatingSSE2
+	};
+	Run(&sSSE2, blockSize, nBlocks);
+	#endif
+
+	#ifdef IPLUG_SIMD_AVX
+	static const Kernels sAVX =
+	{
+		"AVX", CastFloatToDoubleAVX, CastDoubleToFloatAVX, CastDoubleToFloatAccumulatingAVX
+	};
+	if (CPUHasAVX())
+		Run(&sAVX, blockSize, nBlocks);
+	else
+		printf("%-8s  not supported by CPU\n", sAVX.mName);
+	#endif
+
+	#ifdef IPLUG_SIMD_NEON
+	static const Kernels sNEON =
+	{
+		"NEON", CastFloatToDoubleNEON, CastDoubleToFloatNEON, CastDoubleToFloatAccumulatingNEON
+	};
+	Run(&sNEON, blockSize, nBlocks);
+	#endif
+
+	return 0;
+}
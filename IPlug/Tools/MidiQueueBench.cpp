@@ -0,0 +1,137 @@
+// Benchmarks IMidiQueue::Add() with in order and out of order MIDI
+// messages, so the default sorted insertion can be compared against
+// MERGE_SORT_IMIDIQUEUE and DONT_SORT_IMIDIQUEUE. Each scenario adds
+// messages to the queue, and then reads them all back, once per block.
+// Reports time per message, and the number of messages read back out of
+// order (should be 0, unless DONT_SORT_IMIDIQUEUE).
+//
+// Build (Linux, macOS), from this directory:
+//   c++ -O2 -I../.. -o midiqueuebench MidiQueueBench.cpp
+//   c++ -O2 -I../.. -DMERGE_SORT_IMIDIQUEUE -o midiqueuebench MidiQueueBench.cpp
+//   c++ -O2 -I../.. -DDONT_SORT_IMIDIQUEUE -o midiqueuebench MidiQueueBench.cpp
+//
+// Usage: midiqueuebench [events per block] [number of blocks]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+
+#include "IPlug/IMidiQueue.h"
+
+static double GetTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Deterministic, so runs are reproducible.
+static inline unsigned int Rand(unsigned int* const pSeed)
+{
+	return *pSeed = *pSeed * 1664525 + 1013904223;
+}
+
+static const int kBlockSize = 512;
+
+enum EScenario
+{
+	kInOrder = 0,
+	kReversed,    // Burst of messages in reverse order.
+	kInterleaved, // 4 ports, each in order, concatenated.
+	kRandom,
+	kNumScenarios
+};
+
+static const char* const sScenarioNames[kNumScenarios] =
+{
+	"in order",
+	"reversed",
+	"interleaved",
+	"random"
+};
+
+static void MakeOffsets(int* const pOffsets, const int n, const int scenario, unsigned int* const pSeed)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		switch (scenario)
+		{
+			case kInOrder: pOffsets[i] = i * kBlockSize / n; break;
+			case kReversed: pOffsets[i] = (n - 1 - i) * kBlockSize / n; break;
+			case kInterleaved:
+			{
+				const int nPorts = 4, perPort = (n + nPorts - 1) / nPorts;
+				pOffsets[i] = (i % perPort) * kBlockSize / perPort;
+				break;
+			}
+			default: pOffsets[i] = (int)((Rand(pSeed) >> 8) % kBlockSize); break;
+		}
+	}
+}
+
+static void Run(const int scenario, const int nEvents, const int nBlocks)
+{
+	IMidiQueue queue;
+	queue.Resize(nEvents, false);
+
+	WDL_TypedBuf<int> offsets;
+	int* const pOffsets = offsets.Resize(nEvents);
+
+	unsigned int seed = 1;
+	MakeOffsets(pOffsets, nEvents, scenario, &seed);
+
+	IMidiMsg msg(0, IMidiMsg::kNoteOn << 4, 60, 100);
+	int nErrors = 0;
+
+	const double start = GetTime();
+
+	for (int block = 0; block < nBlocks; ++block)
+	{
+		for (int i = 0; i < nEvents; ++i)
+		{
+			msg.mOffset = pOffsets[i];
+			msg.mData1 = (unsigned char)(i & 0x7F);
+			queue.Add(&msg);
+		}
+
+		int prev = 0;
+		while (!queue.Empty())
+		{
+			const IMidiMsg* const pMsg = queue.Peek();
+			nErrors += pMsg->mOffset < prev;
+			prev = pMsg->mOffset;
+			queue.Remove();
+		}
+		queue.Flush(kBlockSize);
+	}
+
+	const double elapsed = GetTime() - start;
+	const double ns = elapsed * 1e9 / ((double)nEvents * (double)nBlocks);
+
+	printf("%-12s %8.2f ns/msg  %d out of order\n", sScenarioNames[scenario], ns, nErrors);
+}
+
+int main(const int argc, const char* const* const argv)
+{
+	const int nEvents = argc > 1 ? atoi(argv[1]) : 64;
+	const int nBlocks = argc > 2 ? atoi(argv[2]) : 20000;
+
+	if (nEvents <= 0 || nBlocks <= 0)
+	{
+		fprintf(stderr, "Usage: %s [events per block] [number of blocks]\n", argv[0]);
+		return 1;
+	}
+
+	#if defined(MERGE_SORT_IMIDIQUEUE)
+	const char* const mode = "MERGE_SORT_IMIDIQUEUE";
+	#elif defined(DONT_SORT_IMIDIQUEUE)
+	const char* const mode = "DONT_SORT_IMIDIQUEUE";
+	#else
+	const char* const mode = "sorted insertion";
+	#endif
+
+	printf("%s, %d messages/block, %d blocks\n", mode, nEvents, nBlocks);
+
+	for (int i = 0; i < kNumScenarios; ++i) Run(i, nEvents, nBlocks);
+
+	return 0;
+}